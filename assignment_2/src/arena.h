@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+
+// Arena
+// Bump allocator for the short-lived buffers of one heuristic call. Memory
+// comes from blocks that are kept when the arena is rewound, so once the
+// blocks have grown to what the largest call needs, later calls are served
+// without touching the heap. Single allocations are never freed: memory is
+// given back by rewinding to an earlier mark (see ArenaScope). Not thread
+// safe; every thread has its own (threadArena()).
+class Arena {
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t firstBlockBytes = 64 * 1024) : firstBlockBytes_(firstBlockBytes) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // align must be a power of two no larger than alignof(max_align_t).
+    void* allocate(size_t bytes, size_t align) {
+        while (true) {
+            if (current_ == blocks_.size()) addBlock(bytes);
+            Block& block = blocks_[current_];
+            size_t offset = (offset_ + align - 1) & ~(align - 1);
+            if (offset + bytes <= block.size) {
+                offset_ = offset + bytes;
+                return block.data.get() + offset;
+            }
+            // Too small blocks are skipped, not split; they are used again
+            // after a rewind.
+            ++current_;
+            offset_ = 0;
+        }
+    }
+
+    Mark mark() const { return { current_, offset_ }; }
+
+    // Frees everything allocated since m was taken.
+    void rewind(Mark m) {
+        current_ = m.block;
+        offset_ = m.offset;
+    }
+
+    // Bytes held in blocks, used or not.
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) total += block.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        unique_ptr<byte[]> data;
+        size_t size;
+    };
+
+    // Blocks double in size, so a call needs O(log bytes) of them.
+    void addBlock(size_t minBytes) {
+        size_t size = blocks_.empty() ? firstBlockBytes_ : 2 * blocks_.back().size;
+        size = max(size, minBytes);
+        blocks_.push_back({ unique_ptr<byte[]>(new byte[size]), size });
+    }
+
+    size_t firstBlockBytes_;
+    vector<Block> blocks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+};
+
+// Standard allocator over an Arena, for containers that must not outlive the
+// ArenaScope they were filled in. deallocate() is a no-op.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    Arena* arena() const { return arena_; }
+
+private:
+    Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() != b.arena(); }
+
+template <typename T>
+using ArenaVector = vector<T, ArenaAllocator<T>>;
+
+// Rewinds the arena to where it was when the scope was opened. Scopes on one
+// arena must nest like the calls that open them, and everything allocated
+// inside must be dead (or never touched again) when the scope closes.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena_(arena), mark_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(mark_); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena_;
+    Arena::Mark mark_;
+};
+
+// Arena of the calling thread, shared by all heuristic calls on it.
+inline Arena& threadArena() {
+    static thread_local Arena arena;
+    return arena;
+}
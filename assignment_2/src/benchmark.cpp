@@ -0,0 +1,238 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include "node.h"
+#include "distance_matrix.h"
+#include "heuristics.h"
+#include "rng.h"
+#include "instance_loader.h"
+#include "instance_generator.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Benchmark
+// Times every constructor in heuristics.h, DistanceMatrix, SolverContext and
+// CSV loading on TSPA/TSPB and on generated instances of increasing size.
+// Each function is run until --reps samples are taken or --budget seconds are spent (at least
+// once). Results go to stdout and, one row per (instance, function), to a CSV
+// file tagged with --label so runs of different builds can be compared.
+// The "model evals/s" column divides a nominal full-scan work count (see
+// scanEvaluations) by the time, so it overstates the variants that skip
+// work (incremental regret, candidates, spatial grid). The spatial grid is
+// only used from kSpatialMinNodes nodes on; below that the Spatial row times
+// the plain row scan. Builds with
+// -DEC_INSTRUMENT also report the insertion evaluations actually counted
+// and heap allocations per call after the warm-up call, i.e. in steady state.
+//
+// Usage: benchmark [--sizes 500,1000,2000] [--reps N] [--budget S]
+//                  [--data DIR] [--out FILE] [--label NAME] [--seed S]
+
+// Wall time of every timed call, and insertion evaluations and heap
+// allocations per call (counted only when instrumented).
+struct Samples {
+    vector<double> ns;
+    double evaluationsPerOp = 0;
+    double allocationsPerOp = 0;
+};
+
+struct BenchResult {
+    string instance;
+    int n;
+    string function;
+    Samples samples;
+    double modelEvaluationsPerOp;
+};
+
+// Keeps the optimizer from dropping the timed calls.
+static long long benchSink = 0;
+
+double percentile(const vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(rank, sorted.size() - 1)];
+}
+
+Samples timeRuns(const function<void(int)>& op, int maxReps, double budgetSeconds) {
+    using clock = chrono::steady_clock;
+    Samples samples;
+    samples.ns.reserve(maxReps);
+    op(0); // warm-up
+    Profile before = profileSnapshot();
+    auto begin = clock::now();
+    for (int rep = 0; rep < maxReps; ++rep) {
+        auto t0 = clock::now();
+        op(rep);
+        auto t1 = clock::now();
+        samples.ns.push_back(chrono::duration<double, nano>(t1 - t0).count());
+        if (chrono::duration<double>(t1 - begin).count() > budgetSeconds) break;
+    }
+    Profile used = profileSnapshot() - before;
+    samples.evaluationsPerOp = static_cast<double>(used.counts[static_cast<int>(Counter::InsertionEvals)]) / samples.ns.size();
+    samples.allocationsPerOp = static_cast<double>(used.counts[static_cast<int>(Counter::Allocations)]) / samples.ns.size();
+    return samples;
+}
+
+// Candidate evaluations a full scan performs for one construction: the work
+// model behind the model evals/s column (m = n / 2 selected nodes).
+double scanEvaluations(const string& function, int n) {
+    double total = 0;
+    int m = n / 2;
+    for (int s = 1; s < m; ++s) {
+        if (function == "nearestNeighborEnd" || function == "nearestNeighborEndSpatial") total += n - s;
+        else if (function == "nearestNeighborFlexible") total += static_cast<double>(n - s) * (s + 1);
+        else total += static_cast<double>(n - s) * s;
+    }
+    return total;
+}
+
+template <typename Dist>
+void benchHeuristics(const string& instance, const vector<Node>& nodes, const Dist& dist,
+                     int reps, double budget, uint64_t seed, vector<BenchResult>& results) {
+    int n = nodes.size();
+    // The per-instance preprocessing a multi-start run pays once
+    results.push_back({ instance, n, "SolverContext",
+                        timeRuns([&](int) {
+                            SolverContext context(dist, nodes);
+                            context.precomputePartners();
+                            benchSink += context.bestPartner(0);
+                        }, reps, budget),
+                        2.0 * n * n });
+
+    SolverContext context(dist, nodes);
+    context.precomputePartners();
+    vector<pair<string, function<void(int)>>> ops = {
+        { "nearestNeighborEnd", [&](int rep) { benchSink += nearestNeighborEnd(context, rep % n).objective; } },
+        { "nearestNeighborEndSpatial", [&](int rep) { benchSink += nearestNeighborEndSpatial(context, rep % n).objective; } },
+        { "nearestNeighborFlexible", [&](int rep) { benchSink += nearestNeighborFlexible(context, rep % n).objective; } },
+        { "greedyCycle", [&](int rep) { benchSink += greedyCycle(context, rep % n).objective; } },
+        { "greedyCycle2Regret", [&](int rep) { benchSink += greedyCycle2Regret(context, rep % n).objective; } },
+    };
+    for (auto& [name, op] : ops)
+        results.push_back({ instance, n, name, timeRuns(op, reps, budget), scanEvaluations(name, n) });
+
+    vector<int> buffer;
+    Xoshiro256 rng(seed);
+    // randomSolution is ~1000x cheaper than the constructors, so it gets
+    // many more samples.
+    results.push_back({ instance, n, "randomSolution",
+                        timeRuns([&](int) { benchSink += randomSolution(n, rng, buffer)[0]; }, reps * 1000, budget),
+                        static_cast<double>((n + 1) / 2) });
+}
+
+void benchInstance(const string& instance, const vector<Node>& nodes, const string& csvFile,
+                   int reps, double budget, uint64_t seed, vector<BenchResult>& results) {
+    int n = nodes.size();
+    if (!csvFile.empty()) {
+        results.push_back({ instance, n, "loadNodes",
+                            timeRuns([&](int) { benchSink += loadNodes(csvFile).size(); }, reps, budget),
+                            static_cast<double>(n) });
+    }
+
+    double pairs = static_cast<double>(n) * (n - 1) / 2;
+    if (DistanceMatrix<uint16_t>::fits(nodes)) {
+        results.push_back({ instance, n, "DistanceMatrix<uint16_t>",
+                            timeRuns([&](int) { benchSink += DistanceMatrix<uint16_t>(nodes)[0][n - 1]; }, reps, budget),
+                            pairs });
+        benchHeuristics(instance, nodes, DistanceMatrix<uint16_t>(nodes), reps, budget, seed, results);
+    } else {
+        results.push_back({ instance, n, "DistanceMatrix<int>",
+                            timeRuns([&](int) { benchSink += DistanceMatrix<int>(nodes)[0][n - 1]; }, reps, budget),
+                            pairs });
+        benchHeuristics(instance, nodes, DistanceMatrix<int>(nodes), reps, budget, seed, results);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    vector<int> sizes = { 500, 1000, 2000 };
+    int reps = 20;
+    double budget = 1.0;
+    string dataDir = "../../data";
+    string outFile = "../results/benchmark.csv";
+    string label = "default";
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) sizes.push_back(stoi(item));
+        } else if (arg == "--reps" && i + 1 < argc) {
+            reps = stoi(argv[++i]);
+            if (reps < 1) {
+                cerr << "Error: --reps must be at least 1\n"
+                     << "Usage: benchmark [--sizes 500,1000,2000] [--reps N] [--budget S] [--data DIR] [--out FILE] "
+                        "[--label NAME] [--seed S]" << endl;
+                return 2;
+            }
+        } else if (arg == "--budget" && i + 1 < argc) {
+            budget = stod(argv[++i]);
+        } else if (arg == "--data" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--label" && i + 1 < argc) {
+            label = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = stoull(argv[++i]);
+        } else {
+            cerr << "Warning: Ignoring unknown argument: " << arg << endl;
+        }
+    }
+
+    vector<BenchResult> results;
+    for (string tsp_type : { "TSPA", "TSPB" }) {
+        string csvFile = dataDir + "/" + tsp_type + ".csv";
+        benchInstance(tsp_type, loadNodes(csvFile), csvFile, reps, budget, seed, results);
+    }
+    for (int n : sizes)
+        benchInstance("uniform" + to_string(n), generateUniformInstance(n, seed + n), "", reps, budget, seed, results);
+
+    ofstream out(outFile);
+    if (!out.is_open()) {
+        cerr << "Error: could not create benchmark file: " << outFile << endl;
+    }
+    out << "label,instance,n,function,samples,mean_ns,min_ns,p50_ns,p90_ns,p99_ns,ops_per_s,model_evals_per_s,"
+           "evals_per_s,allocs_per_op\n";
+
+    size_t nameWidth = 10;
+    for (const BenchResult& r : results) nameWidth = max(nameWidth, r.function.size() + 2);
+    cout << left << setw(12) << "instance" << setw(nameWidth) << "function" << right
+         << setw(8) << "samples" << setw(14) << "mean ns/op" << setw(14) << "p50" << setw(14) << "p99"
+         << setw(16) << "model evals/s" << (kInstrumented ? "       evals/s   allocs/op" : "") << "\n";
+    for (const BenchResult& r : results) {
+        vector<double> sorted = r.samples.ns;
+        sort(sorted.begin(), sorted.end());
+        double mean = accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        double opsPerSecond = 1e9 / mean;
+        double modelEvalsPerSecond = r.modelEvaluationsPerOp * opsPerSecond;
+        double evalsPerSecond = r.samples.evaluationsPerOp * opsPerSecond;
+
+        cout << left << setw(12) << r.instance << setw(nameWidth) << r.function << right << fixed << setprecision(0)
+             << setw(8) << sorted.size() << setw(14) << mean << setw(14) << percentile(sorted, 0.5)
+             << setw(14) << percentile(sorted, 0.99) << scientific << setprecision(2) << setw(16) << modelEvalsPerSecond;
+        if (kInstrumented) {
+            cout << setw(14) << evalsPerSecond << fixed << setprecision(2) << setw(12) << r.samples.allocationsPerOp;
+        }
+        cout << "\n";
+        out << fixed << setprecision(0) << label << "," << r.instance << "," << r.n << "," << r.function << ","
+            << sorted.size() << "," << mean << "," << sorted.front() << "," << percentile(sorted, 0.5) << ","
+            << percentile(sorted, 0.9) << "," << percentile(sorted, 0.99) << "," << setprecision(2)
+            << opsPerSecond << "," << modelEvalsPerSecond << ",";
+        if (kInstrumented) out << evalsPerSecond << "," << r.samples.allocationsPerOp;
+        else out << ",";
+        out << "\n";
+    }
+    out.close();
+
+    cout << "\nBenchmark results saved to: " << outFile << " (checksum " << benchSink % 1000 << ")\n";
+    return 0;
+}
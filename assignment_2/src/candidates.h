@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include "node.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Candidate Lists
+// For every node i, its k best neighbours j ranked by dist[i][j] + cost[j]
+// (lowest id first on ties), stored flat as n rows of k ids. An edge (i, j)
+// is a candidate edge if j is in the list of i. Like DistanceMatrix, the
+// lists can also be a read-only view of external memory (see view()).
+class CandidateLists {
+public:
+    CandidateLists() = default;
+
+    template <typename Dist>
+    CandidateLists(const Dist& dist, const vector<Node>& nodes, int k)
+        : n_(nodes.size()), k_(min<int>(k, max(0, static_cast<int>(nodes.size()) - 1))),
+          lists_(static_cast<size_t>(n_) * k_) {
+        EC_PHASE(Matrix);
+        vector<int> order;
+        vector<int> score(n_);
+        for (int i = 0; i < n_; ++i) {
+            for (int j = 0; j < n_; ++j) score[j] = dist[i][j] + nodes[j].cost;
+            order.resize(n_);
+            iota(order.begin(), order.end(), 0);
+            order.erase(order.begin() + i);
+            partial_sort(order.begin(), order.begin() + k_, order.end(), [&](int a, int b) {
+                return score[a] != score[b] ? score[a] < score[b] : a < b;
+            });
+            copy(order.begin(), order.begin() + k_, lists_.begin() + static_cast<size_t>(i) * k_);
+        }
+    }
+
+    // Non-owning lists over n * k ids at lists, which must outlive them.
+    static CandidateLists view(const int* lists, int n, int k) {
+        CandidateLists candidates;
+        candidates.n_ = n;
+        candidates.k_ = k;
+        candidates.external_ = lists;
+        return candidates;
+    }
+
+    int size() const { return n_; }
+    int k() const { return k_; }
+
+    const int* data() const { return external_ ? external_ : lists_.data(); }
+
+    const int* begin(int i) const { return data() + static_cast<size_t>(i) * k_; }
+    const int* end(int i) const { return begin(i) + k_; }
+
+    bool contains(int i, int j) const {
+        return find(begin(i), end(i), j) != end(i);
+    }
+
+private:
+    int n_ = 0;
+    int k_ = 0;
+    vector<int> lists_;
+    const int* external_ = nullptr;
+};
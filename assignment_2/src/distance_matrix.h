@@ -1,18 +1,113 @@
 #pragma once
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
 #include "node.h"
+#include "instrumentation.h"
 
 using namespace std;
 
-vector<vector<int>> DistanceMatrix(const vector<Node>& nodes) {
-    int n = nodes.size();
-    vector<vector<int>> dist(n, vector<int>(n));
-    for (int i = 0; i < n; ++i)
-        for (int j = 0; j < n; ++j) {
-            double dx = nodes[i].x - nodes[j].x;
-            double dy = nodes[i].y - nodes[j].y;
-            dist[i][j] = static_cast<int>(round(sqrt(dx * dx + dy * dy)));
+// Distance Matrix
+// Contiguous row-major n x n matrix. dist[i] returns a pointer to row i, so
+// heuristics keep reading entries as dist[i][j] without a second indirection.
+// T is the element width: uint16_t halves the cache footprint for instances
+// whose distances fit (see fits()), int is the safe default. A matrix either
+// owns its storage or is a read-only view of external memory (see view()),
+// e.g. a memory-mapped instance cache.
+template <typename T = int>
+class DistanceMatrix {
+public:
+    using value_type = T;
+
+    // Spare elements after the last row, so vector kernels may read a full
+    // 32-bit word at any entry of a 16-bit row.
+    static constexpr size_t kPadding = 8;
+
+    DistanceMatrix() = default;
+
+    explicit DistanceMatrix(int n)
+        : n_(n), data_(static_cast<size_t>(n) * n + kPadding, T(0)), base_(data_.data()) {}
+
+    DistanceMatrix(const DistanceMatrix& other)
+        : n_(other.n_), data_(other.data_), base_(other.isView() ? other.base_ : data_.data()) {}
+
+    DistanceMatrix(DistanceMatrix&& other) noexcept
+        : n_(other.n_), data_(std::move(other.data_)), base_(other.base_) {
+        other.n_ = 0;
+        other.base_ = nullptr;
+    }
+
+    DistanceMatrix& operator=(DistanceMatrix other) noexcept {
+        n_ = other.n_;
+        data_.swap(other.data_);
+        base_ = other.isView() ? other.base_ : data_.data();
+        return *this;
+    }
+
+    // Non-owning matrix over n * n + kPadding entries at data, which must
+    // outlive it. Only the const accessors may be used.
+    static DistanceMatrix view(const T* data, int n) {
+        DistanceMatrix matrix;
+        matrix.n_ = n;
+        matrix.base_ = data;
+        return matrix;
+    }
+
+    // Euclidean distances rounded to the nearest integer. The matrix is
+    // symmetric, so only the upper triangle is computed and then mirrored.
+    explicit DistanceMatrix(const vector<Node>& nodes) : DistanceMatrix(static_cast<int>(nodes.size())) {
+        EC_PHASE(Matrix);
+        for (int i = 0; i < n_; ++i) {
+            T* rowI = (*this)[i];
+            for (int j = i + 1; j < n_; ++j) {
+                T d = static_cast<T>(euclidean(nodes[i], nodes[j]));
+                rowI[j] = d;
+                (*this)[j][i] = d;
+            }
         }
-    return dist;
-}
+    }
+
+    // True if every pairwise distance of the instance is representable in T.
+    // Uses the bounding-box diagonal as an upper bound, so it is O(n).
+    static bool fits(const vector<Node>& nodes) {
+        if (nodes.empty()) return true;
+        int minX = nodes[0].x, maxX = nodes[0].x, minY = nodes[0].y, maxY = nodes[0].y;
+        for (const Node& node : nodes) {
+            minX = min(minX, node.x); maxX = max(maxX, node.x);
+            minY = min(minY, node.y); maxY = max(maxY, node.y);
+        }
+        double dx = static_cast<double>(maxX) - minX;
+        double dy = static_cast<double>(maxY) - minY;
+        return round(sqrt(dx * dx + dy * dy)) <= static_cast<double>(numeric_limits<T>::max());
+    }
+
+    static int euclidean(const Node& a, const Node& b) {
+        double dx = a.x - b.x;
+        double dy = a.y - b.y;
+        return static_cast<int>(round(sqrt(dx * dx + dy * dy)));
+    }
+
+    int size() const { return n_; }
+
+    bool isView() const { return base_ != nullptr && data_.empty(); }
+
+    const T* operator[](int i) const {
+        EC_COUNT(MatrixReads, 1);
+        return base_ + static_cast<size_t>(i) * n_;
+    }
+    T* operator[](int i) { return data_.data() + static_cast<size_t>(i) * n_; }
+
+    const T* data() const { return base_; }
+
+private:
+    int n_ = 0;
+    vector<T> data_;
+    const T* base_ = nullptr;   // data_.data(), or the viewed memory
+};
+
+// Row for full-row scans (see maskedArgmin). Providers that compute
+// distances on demand overload this to hand out a materialized row.
+template <typename T>
+const T* scanRow(const DistanceMatrix<T>& dist, int i) { return dist[i]; }
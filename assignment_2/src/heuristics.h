@@ -4,27 +4,46 @@
 #include <algorithm>
 #include <numeric>
 #include <limits>
-#include <random>
 #include "node.h"
+#include "distance_matrix.h"
+#include "solution.h"
+#include "insertion.h"
+#include "regret_insertion.h"
+#include "candidates.h"
+#include "simd_kernels.h"
+#include "spatial_index.h"
+#include "tour.h"
+#include "solver_context.h"
+#include "unvisited_set.h"
+#include "arena.h"
+#include "instrumentation.h"
 
 using namespace std;
 
 // Node Selection
-vector<int> selectNodes(int totalNodes) {
+// Partial Fisher-Yates: buffer holds a permutation of all node ids and is kept
+// between calls, so only the first k slots are shuffled and nothing is
+// allocated. The selected nodes are buffer[0..k), in uniformly random order.
+template <typename Rng>
+int selectNodes(int totalNodes, Rng& rng, vector<int>& buffer) {
     int k = (totalNodes + 1) / 2;
-    vector<int> indices(totalNodes);
-    iota(indices.begin(), indices.end(), 0);
-
-    shuffle(indices.begin(), indices.end(), mt19937{random_device{}()});
-    indices.resize(k);
-    return indices;
+    if (buffer.size() != static_cast<size_t>(totalNodes)) {
+        buffer.resize(totalNodes);
+        iota(buffer.begin(), buffer.end(), 0);
+    }
+    for (int i = 0; i < k; ++i) {
+        int j = i + static_cast<int>(rng.below(totalNodes - i));
+        swap(buffer[i], buffer[j]);
+    }
+    return k;
 }
 
 // Objective Function
-// Objective Function
+template <typename Dist>
 int computeObjective(const vector<int>& path,
-                     const vector<vector<int>>& dist,
+                     const Dist& dist,
                      const vector<Node>& nodes) {
+    EC_COUNT(ObjectiveEvals, 1);
     int totalDist = 0;
     int totalCost = 0;
 
@@ -36,108 +55,166 @@ int computeObjective(const vector<int>& path,
     return totalDist + totalCost;
 }
 
-
 // Random Solution
-vector<int> randomSolution(const vector<int>& selectedNodes) {
-    vector<int> path = selectedNodes;
-    shuffle(path.begin(), path.end(), mt19937{random_device{}()});
+// The partial shuffle already orders the sample randomly, so the cycle is
+// just the selected nodes in buffer order, closed back to the first.
+template <typename Rng>
+vector<int> randomSolution(int totalNodes, Rng& rng, vector<int>& buffer) {
+    EC_PHASE(Construction);
+    int k = selectNodes(totalNodes, rng, buffer);
+    vector<int> path;
+    path.reserve(k + 1);
+    path.assign(buffer.begin(), buffer.begin() + k);
     path.push_back(path[0]);
     return path;
 }
 
 // Nearest Neighbor Heuristics (To the End)
-vector<int> nearestNeighborEnd(const vector<vector<int>>& dist,
-                               const vector<Node>& nodes,
-                               int startNodeId) {
-    vector<int> path = { startNodeId };
-    int maxSize = nodes.size() / 2;
-    vector<bool> visited(nodes.size(), false);
-    visited[startNodeId] = true;
+template <typename Dist>
+Solution nearestNeighborEnd(const SolverContext<Dist>& context, int startNodeId) {
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    const int n = context.size();
+    int maxSize = n / 2;
+    vector<int> path;
+    path.reserve(maxSize + 1);
+    path.push_back(startNodeId);
+    ArenaScope scope(threadArena());
+    UnvisitedSet unvisited(n, threadArena());
+    unvisited.remove(startNodeId);
+    int objective = 0;
 
     while (path.size() < static_cast<size_t>(maxSize)) {
-        int bestNode = -1;
-        int bestScore = numeric_limits<int>::max();
+        int bestScore;
+        int bestNode = maskedArgmin(scanRow(dist, path.back()), context.costs(), unvisited.removedMask(), n, bestScore);
 
-        for (const Node& node : nodes) {
-            if (visited[node.id]) continue;
+        path.push_back(bestNode);
+        unvisited.remove(bestNode);
+        objective += bestScore;
+    }
+    objective += dist[path.back()][startNodeId] + nodes[startNodeId].cost;
+    path.push_back(startNodeId);
+    return { move(path), objective };
+}
 
-            int score = dist[path.back()][node.id] + node.cost;
+// Nearest Neighbor Heuristics (To the End, spatial index)
+// Same choices as nearestNeighborEnd, but each step asks a SpatialGrid for
+// the nearest remaining node instead of scanning a full row, so a step only
+// looks at the cells around the current end. The grid is a copy of the
+// context's, so it is not rebuilt per call, but the copy and the cell walks
+// only pay off on large instances: on uniform and clustered instances the
+// grid is about 13x slower at n = 200, breaks even near n = 3000 and is
+// about 3x faster at n = 10000. Below kSpatialMinNodes it runs the row scan.
+constexpr int kSpatialMinNodes = 3000;
+
+template <typename Dist>
+Solution nearestNeighborEndSpatial(const SolverContext<Dist>& context, int startNodeId) {
+    const int n = context.size();
+    if (n < kSpatialMinNodes) return nearestNeighborEnd(context, startNodeId);
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    int maxSize = n / 2;
+    vector<int> path;
+    path.reserve(maxSize + 1);
+    path.push_back(startNodeId);
+    SpatialGrid& grid = context.scratch().grid;
+    grid = context.grid();
+    grid.remove(startNodeId);
+    int objective = 0;
 
-            if (score < bestScore) {
-                bestScore = score;
-                bestNode = node.id;
-            }
-        }
+    while (path.size() < static_cast<size_t>(maxSize)) {
+        int bestScore;
+        int bestNode = grid.nearest(path.back(), true, bestScore);
 
         path.push_back(bestNode);
-        visited[bestNode] = true;
+        grid.remove(bestNode);
+        objective += bestScore;
     }
+    objective += dist[path.back()][startNodeId] + nodes[startNodeId].cost;
     path.push_back(startNodeId);
-    return path;
+    return { move(path), objective };
 }
 
 // Nearest Neighbor Heuristics (At any place)
-vector<int> nearestNeighborFlexible(const vector<vector<int>>& dist,
-                                    const vector<Node>& nodes,
-                                    int startNodeId) {
-    vector<int> path = { startNodeId };
-    int maxSize = nodes.size() / 2;
-    vector<bool> visited(nodes.size(), false);
-    visited[startNodeId] = true;
+template <typename Dist>
+Solution nearestNeighborFlexible(const SolverContext<Dist>& context, int startNodeId) {
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    const int n = context.size();
+    int maxSize = n / 2;
+    vector<int> path;
+    path.reserve(maxSize + 1);
+    path.push_back(startNodeId);
+    ArenaScope scope(threadArena());
+    UnvisitedSet unvisited(n, threadArena());
+    unvisited.remove(startNodeId);
+    int objective = 0;
 
     while (path.size() < static_cast<size_t>(maxSize)) {
         int bestNode = -1;
         int bestPos = -1;
         int bestScore = numeric_limits<int>::max();
 
-        for (const Node& node : nodes) {
-            if (visited[node.id]) continue;
-
+        //ties go to the lowest node id, then the lowest position
+        for (int k : unvisited) {
+            int nodeScore = numeric_limits<int>::max();
+            int nodePos = -1;
             for (size_t i = 0; i <= path.size(); ++i) {
-                vector<int> tempPath = path;
-                tempPath.insert(tempPath.begin() + i, node.id);
-                int score = computeObjective(tempPath, dist, nodes);
-
-                if (score < bestScore) {
-                    bestScore = score;
-                    bestNode = node.id;
-                    bestPos = i;
+                int score = insertionDelta(path, dist, nodes, k, i);
+                if (score < nodeScore) {
+                    nodeScore = score;
+                    nodePos = i;
                 }
             }
+
+            if (nodeScore < bestScore || (nodeScore == bestScore && k < bestNode)) {
+                bestScore = nodeScore;
+                bestNode = k;
+                bestPos = nodePos;
+            }
         }
 
         path.insert(path.begin() + bestPos, bestNode);
-        visited[bestNode] = true;
+        unvisited.remove(bestNode);
+        objective += bestScore;
     }
+    objective += dist[path.back()][path[0]] + nodes[path.back()].cost;
     path.push_back(path[0]);
-    return path;
+    return { move(path), objective };
 }
 
 // Greedy Cycle Heuristic
-vector<int> greedyCycle(const vector<vector<int>>& dist,
-                        const vector<Node>& nodes,
-                        int startNodeId) {
-    vector<int> path = { startNodeId };
-    int numToSelect = nodes.size() / 2;
-    vector<bool> visited(nodes.size(), false);
-    visited[startNodeId] = true;
-
-    //select the best second node to form initial 2-node cycle
-    int bestSecondNode = -1;
-    int bestInitialScore = numeric_limits<int>::max();
-    for (const Node& node : nodes) {
-        if (visited[node.id]) continue;
-        int score = dist[startNodeId][node.id] + nodes[startNodeId].cost + node.cost;
-        if (score < bestInitialScore) {
-            bestInitialScore = score;
-            bestSecondNode = node.id;
-        }
-    }
+template <typename Dist>
+Solution greedyCycle(const SolverContext<Dist>& context, int startNodeId) {
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    SolverScratch& scratch = context.scratch();
+    const int n = context.size();
+    int numToSelect = n / 2;
+    vector<int> path;
+    path.reserve(numToSelect + 1);
+    path.push_back(startNodeId);
+
+    //the best second node to form the initial 2-node cycle comes from the
+    //context (the start node's cost is the same for every candidate)
+    int bestSecondNode = context.bestPartner(startNodeId);
+    ArenaScope scope(threadArena());
+    UnvisitedSet unvisited(n, threadArena());
+    unvisited.remove(startNodeId);
 
     path.push_back(bestSecondNode);
-    visited[bestSecondNode] = true;
+    unvisited.remove(bestSecondNode);
     path.push_back(startNodeId);
+    int objective = 2 * dist[startNodeId][bestSecondNode] + nodes[startNodeId].cost + nodes[bestSecondNode].cost;
+
 
+    //edge lengths kept alongside the path: edgeLen[i] = dist[path[i]][path[i + 1]]
+    vector<int>& edgeLen = scratch.edgeLen;
+    edgeLen.assign({ dist[path[0]][path[1]], dist[path[1]][path[2]] });
 
     //iteratively insert remaining nodes
     while (path.size() < static_cast<size_t>(numToSelect+1)) {
@@ -145,94 +222,139 @@ vector<int> greedyCycle(const vector<vector<int>>& dist,
         int bestPos = -1;
         int bestScore = numeric_limits<int>::max();
 
-        for (const Node& node : nodes) {
-            if (visited[node.id]) continue;
-
-            for (size_t i = 0; i < path.size() -1; ++i) {
-                vector<int> tempPath = path;
-                tempPath.insert(tempPath.begin() + i, node.id);
-                int score = computeObjective(tempPath, dist, nodes);
+        //ties go to the lowest node id, then the lowest position
+        for (int k : unvisited) {
+            //position 0 puts the node in front of the path (see insertionDelta)
+            int score = insertionDelta(path, dist, nodes, k, 0);
+            if (score < bestScore || (score == bestScore && k < bestNode)) {
+                bestScore = score;
+                bestNode = k;
+                bestPos = 0;
+            }
 
-                if (score < bestScore) {
-                    bestScore = score;
-                    bestNode = node.id;
-                    bestPos = i;
-                }
+            //position i >= 1 splits edge i - 1; all of them in one vectorized pass
+            BestTwo edges = bestInsertions(dist[k], path.data(), edgeLen.data(), path.size() - 2);
+            if (edges.bestPos == -1) continue;
+            score = edges.best + nodes[k].cost;
+            if (score < bestScore || (score == bestScore && k < bestNode)) {
+                bestScore = score;
+                bestNode = k;
+                bestPos = edges.bestPos + 1;
             }
         }
 
+        if (bestPos == 0) {
+            edgeLen.insert(edgeLen.begin(), dist[bestNode][path[0]]);
+        } else {
+            edgeLen[bestPos - 1] = dist[path[bestPos - 1]][bestNode];
+            edgeLen.insert(edgeLen.begin() + bestPos, dist[bestNode][path[bestPos]]);
+        }
         path.insert(path.begin() + bestPos, bestNode);
-        visited[bestNode] = true;
+        unvisited.remove(bestNode);
+        objective += bestScore;
     }
 
-    return path;
+    return { move(path), objective };
 }
 
 
-// Greedy Cycle 2-regret Heuristic
-vector<int> greedyCycle2Regret(const vector<vector<int>>& dist,
-                                const vector<Node>& nodes,
-                                int startNodeId) {
-    vector<int> path = { startNodeId };
-    int numToSelect = nodes.size() / 2;
-    vector<bool> visited(nodes.size(), false);
-    visited[startNodeId] = true;
-
-    int bestSecondNode = -1;
-    int bestInitialDist = numeric_limits<int>::max();
-    for (const Node& node : nodes) {
-        if (visited[node.id]) continue;
-        if (dist[startNodeId][node.id] < bestInitialDist) {
-            bestInitialDist = dist[startNodeId][node.id];
-            bestSecondNode = node.id;
-        }
-    }
-    path.push_back(bestSecondNode);
-    visited[bestSecondNode] = true;
-    path.push_back(startNodeId);
+// Greedy Cycle Heuristic (candidate edges only)
+// Same greedy rule on a proper cycle, but an insertion of k into (u, v) is
+// only considered when k is a candidate of u or of v, which makes each step
+// O(m * k). Falls back to a full scan when no candidate is left unvisited.
+// The cycle is a LinkedTour, so an insertion is O(1) instead of a shift.
+// Requires a context with candidate lists.
+template <typename Dist>
+Solution greedyCycleCandidates(const SolverContext<Dist>& context, int startNodeId) {
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    const CandidateLists& candidates = context.candidates();
+    SolverScratch& scratch = context.scratch();
+    const int n = context.size();
+    int numToSelect = n / 2;
+    ArenaScope scope(threadArena());
+    UnvisitedSet unvisited(n, threadArena());
+    unvisited.remove(startNodeId);
+
+    //the first candidate is the best partner; with empty lists (k = 0) ask the context
+    int secondNode = candidates.k() > 0 ? *candidates.begin(startNodeId) : context.bestPartner(startNodeId);
+    LinkedTour& tour = scratch.tour;
+    tour.reset(n);
+    tour.start(startNodeId);
+    tour.insertAfter(startNodeId, secondNode);
+    unvisited.remove(secondNode);
+    int objective = 2 * dist[startNodeId][secondNode] + nodes[startNodeId].cost + nodes[secondNode].cost;
+
+    while (tour.size() < numToSelect) {
+        int bestNode = -1;
+        int bestAfter = -1;
+        int bestScore = numeric_limits<int>::max();
 
-    while (path.size() < static_cast<size_t>(numToSelect + 1)) {
-        int bestNodeToInsert = -1;
-        int bestPosition = -1;
-        double maxRegret = -1.0;
-
-        for (const Node& node : nodes) {
-            if (visited[node.id]) continue;
-            
-            int k = node.id;
-            int BestCost = numeric_limits<int>::max();
-            int SecondBestCost = numeric_limits<int>::max();
-            int PositionForBestCost = -1;
-
-            for (size_t i = 0; i < path.size() - 1; ++i) {
-                int u = path[i];
-                int v = path[i + 1];
-                
-                int insertionCost = dist[u][k] + dist[k][v] - dist[u][v];
-
-                if (insertionCost < BestCost) {
-                    SecondBestCost = BestCost;
-                    BestCost = insertionCost;
-                    PositionForBestCost = i + 1;
-                } else if (insertionCost < SecondBestCost) {
-                    SecondBestCost = insertionCost;
-                }
+        auto consider = [&](int k, int u) {
+            int score = insertionCost(dist, u, k, tour.next(u)) + nodes[k].cost;
+            if (score < bestScore) {
+                bestScore = score;
+                bestNode = k;
+                bestAfter = u;
             }
-
-            double regret = SecondBestCost - BestCost;
-
-            if (regret > maxRegret) {
-                maxRegret = regret;
-                bestNodeToInsert = k;
-                bestPosition = PositionForBestCost;
+        };
+
+        tour.forEach([&](int u) {
+            for (int end : { u, tour.next(u) })
+                for (const int* c = candidates.begin(end); c != candidates.end(end); ++c)
+                    if (unvisited.contains(*c)) consider(*c, u);
+        });
+        //rare, so it keeps the id order instead of tie-breaking explicitly
+        if (bestNode == -1) {
+            for (int k = 0; k < n; ++k) {
+                if (!unvisited.contains(k)) continue;
+                tour.forEach([&](int u) { consider(k, u); });
             }
         }
 
-        if (bestNodeToInsert == -1) break; 
-        
-        path.insert(path.begin() + bestPosition, bestNodeToInsert);
-        visited[bestNodeToInsert] = true;
+        tour.insertAfter(bestAfter, bestNode);
+        unvisited.remove(bestNode);
+        objective += bestScore;
     }
 
-    return path;
+    return { tour.toPath(), objective };
+}
+
+// Greedy Cycle K-regret Heuristic
+// Seeds a 2-node cycle with the start node's nearest neighbour and grows it
+// with the incremental RegretInserter (see regret_insertion.h), whose state
+// is taken from the thread's arena and dropped on return.
+template <int K, typename Dist>
+Solution greedyCycleKRegret(const SolverContext<Dist>& context,
+                            int startNodeId,
+                            RegretWeights weights = {}) {
+    EC_PHASE(Construction);
+    const Dist& dist = context.dist();
+    const vector<Node>& nodes = context.nodes();
+    const int n = context.size();
+    int numToSelect = n / 2;
+    vector<int> path;
+    path.reserve(numToSelect + 1);
+    path.push_back(startNodeId);
+
+    int bestSecondNode = context.nearestPartner(startNodeId);
+    ArenaScope scope(threadArena());
+    UnvisitedSet unvisited(n, threadArena());
+    unvisited.remove(startNodeId);
+    path.push_back(bestSecondNode);
+    unvisited.remove(bestSecondNode);
+    path.push_back(startNodeId);
+    int objective = 2 * dist[startNodeId][bestSecondNode] + nodes[startNodeId].cost + nodes[bestSecondNode].cost;
+
+    RegretInserter<K, Dist> inserter(dist, nodes, threadArena(), weights);
+    objective += inserter.run(path, unvisited, numToSelect);
+
+    return { move(path), objective };
+}
+
+// Greedy Cycle 2-regret Heuristic
+template <typename Dist>
+Solution greedyCycle2Regret(const SolverContext<Dist>& context, int startNodeId) {
+    return greedyCycleKRegret<2>(context, startNodeId);
 }
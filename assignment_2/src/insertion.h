@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "node.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Insertion Delta
+// Cost of splicing node k into the cycle edge (u, v), node cost excluded.
+template <typename Dist>
+inline int insertionCost(const Dist& dist, int u, int k, int v) {
+    EC_COUNT(InsertionEvals, 1);
+    return dist[u][k] + dist[k][v] - dist[u][v];
+}
+
+// Change of computeObjective when node k is inserted at index pos of path,
+// in O(1). computeObjective does not count the cost of the last element, so
+// the open ends are special: a new first node pays its own cost, a new last
+// node makes the previous last node pay its cost instead.
+template <typename Dist>
+int insertionDelta(const vector<int>& path,
+                   const Dist& dist,
+                   const vector<Node>& nodes,
+                   int k,
+                   size_t pos) {
+    size_t m = path.size();
+    if (m == 0) return 0;
+    if (pos == 0 || pos == m) EC_COUNT(InsertionEvals, 1);
+    if (pos == 0) return dist[k][path[0]] + nodes[k].cost;
+    if (pos == m) return dist[path[m - 1]][k] + nodes[path[m - 1]].cost;
+    return insertionCost(dist, path[pos - 1], k, path[pos]) + nodes[k].cost;
+}
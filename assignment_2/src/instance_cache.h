@@ -0,0 +1,177 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include "node.h"
+#include "distance_matrix.h"
+#include "candidates.h"
+#include "instance_loader.h"
+
+using namespace std;
+
+// Binary Instance Cache
+// One file per instance, written by the prepare tool and memory-mapped by the
+// solver and the checker:
+//
+//   InstanceCacheHeader
+//   n Nodes                                  (at nodesOffset)
+//   n * n + kPadding matrix entries          (at matrixOffset, elementSize bytes each)
+//   n * candidateK candidate ids, optional   (at candidatesOffset, 0 if absent)
+//
+// Sections start at 64-byte boundaries. The header records the size and an
+// FNV-1a checksum of the source CSV; a cache whose CSV has changed is
+// rejected, and so is any other version of the format.
+
+constexpr char kInstanceCacheMagic[8] = { 'E', 'C', 'I', 'N', 'S', 'T', '\0', '\0' };
+constexpr uint32_t kInstanceCacheVersion = 1;
+
+struct InstanceCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t elementSize;   // 2 (uint16_t) or 4 (int)
+    int32_t n;
+    int32_t candidateK;     // 0 if no candidate lists are stored
+    uint64_t csvSize;
+    uint64_t csvChecksum;
+    uint64_t nodesOffset;
+    uint64_t matrixOffset;
+    uint64_t candidatesOffset;
+    uint64_t fileSize;
+};
+
+// Cache file used for a CSV path.
+inline string instanceCachePath(const string& csvFile) { return csvFile + ".bin"; }
+
+inline uint64_t fnv1a64(const char* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+inline uint64_t alignSection(uint64_t offset) { return (offset + 63) & ~uint64_t(63); }
+
+// Writes the cache for nodes loaded from csvFile; candidates may be null.
+template <typename T>
+bool writeInstanceCache(const string& cacheFile, const string& csvFile, const vector<Node>& nodes,
+                        const DistanceMatrix<T>& dist, const CandidateLists* candidates) {
+    MappedFile csv(csvFile);
+    if (!csv.opened()) {
+        cerr << "Error: Could not open file " << csvFile << endl;
+        return false;
+    }
+
+    int n = nodes.size();
+    InstanceCacheHeader header{};
+    memcpy(header.magic, kInstanceCacheMagic, sizeof(header.magic));
+    header.version = kInstanceCacheVersion;
+    header.elementSize = sizeof(T);
+    header.n = n;
+    header.candidateK = candidates ? candidates->k() : 0;
+    header.csvSize = csv.size();
+    header.csvChecksum = fnv1a64(csv.begin(), csv.size());
+    header.nodesOffset = alignSection(sizeof(header));
+    header.matrixOffset = alignSection(header.nodesOffset + sizeof(Node) * n);
+    uint64_t matrixBytes = (static_cast<uint64_t>(n) * n + DistanceMatrix<T>::kPadding) * sizeof(T);
+    uint64_t end = header.matrixOffset + matrixBytes;
+    if (candidates) {
+        header.candidatesOffset = alignSection(end);
+        end = header.candidatesOffset + static_cast<uint64_t>(n) * candidates->k() * sizeof(int);
+    }
+    header.fileSize = end;
+
+    ofstream out(cacheFile, ios::binary);
+    if (!out.is_open()) {
+        cerr << "Error: could not create " << cacheFile << endl;
+        return false;
+    }
+    auto writeAt = [&](uint64_t offset, const void* data, size_t bytes) {
+        static const char zeros[64] = {};
+        out.write(zeros, offset - static_cast<uint64_t>(out.tellp()));
+        out.write(static_cast<const char*>(data), bytes);
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.nodesOffset, nodes.data(), sizeof(Node) * n);
+    writeAt(header.matrixOffset, dist.data(), matrixBytes);
+    if (candidates)
+        writeAt(header.candidatesOffset, candidates->data(), static_cast<size_t>(n) * candidates->k() * sizeof(int));
+    return static_cast<bool>(out);
+}
+
+// Read-only view of a cache file. valid() is false, with the reason in
+// error(), if the file is missing, malformed, of another version or stale
+// with respect to csvFile. Matrices and candidate lists handed out are views
+// into the mapping and must not outlive this object.
+class InstanceCache {
+public:
+    InstanceCache(const string& cacheFile, const string& csvFile) : file_(cacheFile) {
+        EC_PHASE(Load);
+        if (!file_.opened() || file_.size() < sizeof(InstanceCacheHeader)) {
+            error_ = "missing or truncated cache " + cacheFile;
+            return;
+        }
+        memcpy(&header_, file_.begin(), sizeof(header_));
+        if (memcmp(header_.magic, kInstanceCacheMagic, sizeof(header_.magic)) != 0) {
+            error_ = cacheFile + " is not an instance cache";
+        } else if (header_.version != kInstanceCacheVersion) {
+            error_ = cacheFile + " has format version " + to_string(header_.version) + ", expected "
+                     + to_string(kInstanceCacheVersion);
+        } else if (header_.fileSize != file_.size() || !sectionsFit()) {
+            error_ = cacheFile + " is corrupt";
+        } else {
+            MappedFile csv(csvFile);
+            if (!csv.opened() || csv.size() != header_.csvSize
+                || fnv1a64(csv.begin(), csv.size()) != header_.csvChecksum)
+                error_ = cacheFile + " does not match " + csvFile;
+        }
+    }
+
+    // found() is true if the cache file exists, valid or not.
+    bool found() const { return file_.opened(); }
+    bool valid() const { return error_.empty(); }
+    const string& error() const { return error_; }
+
+    int size() const { return header_.n; }
+    int elementSize() const { return header_.elementSize; }
+    int candidateK() const { return header_.candidateK; }
+
+    vector<Node> nodes() const {
+        const Node* begin = reinterpret_cast<const Node*>(file_.begin() + header_.nodesOffset);
+        return vector<Node>(begin, begin + header_.n);
+    }
+
+    // Requires sizeof(T) == elementSize().
+    template <typename T>
+    DistanceMatrix<T> matrix() const {
+        return DistanceMatrix<T>::view(reinterpret_cast<const T*>(file_.begin() + header_.matrixOffset), header_.n);
+    }
+
+    // Requires candidateK() > 0.
+    CandidateLists candidates() const {
+        return CandidateLists::view(reinterpret_cast<const int*>(file_.begin() + header_.candidatesOffset),
+                                    header_.n, header_.candidateK);
+    }
+
+private:
+    bool sectionsFit() const {
+        if (header_.elementSize != 2 && header_.elementSize != 4) return false;
+        if (header_.n < 0 || header_.candidateK < 0) return false;
+        uint64_t n = header_.n;
+        uint64_t matrixBytes = (n * n + DistanceMatrix<int>::kPadding) * header_.elementSize;
+        return header_.nodesOffset >= sizeof(InstanceCacheHeader)
+            && header_.nodesOffset + n * sizeof(Node) <= header_.matrixOffset
+            && header_.matrixOffset % 64 == 0
+            && header_.matrixOffset + matrixBytes <= header_.fileSize
+            && (header_.candidateK == 0
+                || header_.candidatesOffset + n * header_.candidateK * sizeof(int) <= header_.fileSize);
+    }
+
+    MappedFile file_;
+    InstanceCacheHeader header_{};
+    string error_;
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include "node.h"
+#include "rng.h"
+
+using namespace std;
+
+// Node placement of a synthetic instance.
+//  Uniform:   coordinates uniform in [0, width) x [0, height)
+//  Clustered: Gaussian clouds around `clusters` uniform centres, clamped to the box
+//  Grid:      row-major lattice points spread evenly over the box
+enum class Layout { Uniform, Clustered, Grid };
+
+// Node cost distribution, all within [minCost, maxCost].
+//  Uniform:     uniform integers
+//  Exponential: minCost + exponential with mean (maxCost - minCost) / 4, capped
+//  Constant:    (minCost + maxCost) / 2 for every node
+enum class CostDistribution { Uniform, Exponential, Constant };
+
+// Defaults match the coordinate and cost ranges of TSPA/TSPB.
+struct InstanceOptions {
+    Layout layout = Layout::Uniform;
+    CostDistribution costs = CostDistribution::Uniform;
+    int width = 4000;
+    int height = 2000;
+    int minCost = 0;
+    int maxCost = 2000;
+    int clusters = 0;   // Clustered only; 0 means one cluster per 100 nodes
+};
+
+// Same options with the box grown so n nodes have the node density of the
+// 200-node TSPA/TSPB instances; keeps edge lengths comparable across sizes.
+inline InstanceOptions densityMatched(InstanceOptions options, int n) {
+    double scale = sqrt(n / 200.0);
+    options.width = max(1, static_cast<int>(lround(options.width * scale)));
+    options.height = max(1, static_cast<int>(lround(options.height * scale)));
+    return options;
+}
+
+inline int generateCost(const InstanceOptions& options, Xoshiro256& rng) {
+    int span = options.maxCost - options.minCost;
+    switch (options.costs) {
+    case CostDistribution::Exponential: {
+        double sample = -log(1.0 - rng.unit()) * span / 4.0;
+        return options.minCost + static_cast<int>(min<double>(sample, span));
+    }
+    case CostDistribution::Constant:
+        return options.minCost + span / 2;
+    default:
+        return options.minCost + static_cast<int>(rng.below(span + 1));
+    }
+}
+
+// Synthetic instance of n nodes; the same (n, options, seed) always gives the
+// same nodes.
+inline vector<Node> generateInstance(int n, const InstanceOptions& options, uint64_t seed) {
+    Xoshiro256 rng(seed);
+    vector<Node> nodes(n);
+
+    if (options.layout == Layout::Clustered) {
+        int clusters = options.clusters > 0 ? options.clusters : max(1, n / 100);
+        vector<pair<double, double>> centres(clusters);
+        for (auto& centre : centres)
+            centre = { rng.unit() * options.width, rng.unit() * options.height };
+        // Spread so that the clouds together cover roughly the whole box.
+        double sigma = 0.5 * sqrt(static_cast<double>(options.width) * options.height / clusters);
+        for (int i = 0; i < n; ++i) {
+            const auto& centre = centres[rng.below(clusters)];
+            // Box-Muller
+            double radius = sigma * sqrt(-2.0 * log(1.0 - rng.unit()));
+            double angle = 2.0 * M_PI * rng.unit();
+            double x = centre.first + radius * cos(angle);
+            double y = centre.second + radius * sin(angle);
+            nodes[i].x = static_cast<int>(clamp(x, 0.0, options.width - 1.0));
+            nodes[i].y = static_cast<int>(clamp(y, 0.0, options.height - 1.0));
+        }
+    } else if (options.layout == Layout::Grid) {
+        int columns = max(1, static_cast<int>(ceil(sqrt(static_cast<double>(n) * options.width / options.height))));
+        int rows = (n + columns - 1) / columns;
+        for (int i = 0; i < n; ++i) {
+            nodes[i].x = static_cast<int>(static_cast<long long>(i % columns) * options.width / columns);
+            nodes[i].y = static_cast<int>(static_cast<long long>(i / columns) * options.height / rows);
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            nodes[i].x = rng.below(options.width);
+            nodes[i].y = rng.below(options.height);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        nodes[i].id = i;
+        nodes[i].cost = generateCost(options, rng);
+    }
+    return nodes;
+}
+
+// Synthetic instance with uniform coordinates and costs in the TSPA/TSPB ranges.
+inline vector<Node> generateUniformInstance(int n, uint64_t seed,
+                                            int width = 4000, int height = 2000,
+                                            int minCost = 0, int maxCost = 2000) {
+    InstanceOptions options;
+    options.width = width;
+    options.height = height;
+    options.minCost = minCost;
+    options.maxCost = maxCost;
+    return generateInstance(n, options, seed);
+}
+
+// Writes nodes in the "x;y;cost" format read by loadNodes.
+inline bool saveNodes(const string& filename, const vector<Node>& nodes) {
+    ofstream out(filename);
+    if (!out.is_open()) {
+        cerr << "Error: could not create " << filename << endl;
+        return false;
+    }
+    for (const Node& node : nodes)
+        out << node.x << ";" << node.y << ";" << node.cost << "\n";
+    return true;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <algorithm>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "node.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Read-only memory map of a whole file; empty if it cannot be opened.
+// mmap on POSIX systems, a file mapping view on Windows.
+class MappedFile {
+public:
+#ifdef _WIN32
+    explicit MappedFile(const string& filename) {
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER info;
+        if (GetFileSizeEx(file, &info) && info.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                // The view keeps the mapping alive after its handle is closed.
+                if (void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+                    data_ = static_cast<const char*>(data);
+                    size_ = static_cast<size_t>(info.QuadPart);
+                }
+                CloseHandle(mapping);
+            }
+        }
+        opened_ = true;
+        CloseHandle(file);
+    }
+
+    ~MappedFile() {
+        if (data_) UnmapViewOfFile(data_);
+    }
+#else
+    explicit MappedFile(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                size_ = info.st_size;
+                madvise(data, size_, MADV_SEQUENTIAL);
+            }
+        }
+        opened_ = true;
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool opened() const { return opened_; }
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool opened_ = false;
+};
+
+// Parses an optionally signed decimal int at p, skipping leading blanks.
+// Advances p past it; false if there is no number or it overflows int.
+inline bool parseInt(const char*& p, const char* end, int& value) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+')) ++p;
+    const char* digits = p;
+    long long result = 0;
+    while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+        result = result * 10 + (*p - '0');
+        if (result > static_cast<long long>(INT_MAX) + 1) return false;
+        ++p;
+    }
+    if (p == digits) return false;
+    if (negative) result = -result;
+    if (result > INT_MAX) return false;
+    value = static_cast<int>(result);
+    return true;
+}
+
+// Parses one "x;y;cost" line in [p, end); blanks around fields and a
+// trailing '\r' are allowed.
+inline bool parseNodeLine(const char* p, const char* end, Node& node) {
+    int* fields[3] = { &node.x, &node.y, &node.cost };
+    for (int f = 0; f < 3; ++f) {
+        if (!parseInt(p, end, *fields[f])) return false;
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (f < 2) {
+            if (p == end || *p != ';') return false;
+            ++p;
+        }
+    }
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p == end;
+}
+
+// Read the nodes from a "x;y;cost" .CSV file; node ids are line indices
+// (counting well-formed lines only). The file is memory-mapped and parsed in
+// place. Malformed lines are reported with their line number and skipped;
+// blank lines are skipped silently.
+inline vector<Node> loadNodes(const string& filename) {
+    EC_PHASE(Load);
+    MappedFile file(filename);
+    if (!file.opened()) {
+        cerr << "Error: Could not open file " << filename << endl;
+        return {};
+    }
+
+    vector<Node> nodes;
+    nodes.reserve(count(file.begin(), file.end(), '\n') + 1);
+
+    int lineNumber = 0;
+    for (const char* line = file.begin(); line < file.end();) {
+        const char* newline = static_cast<const char*>(memchr(line, '\n', file.end() - line));
+        const char* lineEnd = newline ? newline : file.end();
+        ++lineNumber;
+
+        Node node;
+        if (parseNodeLine(line, lineEnd, node)) {
+            node.id = nodes.size();
+            nodes.push_back(node);
+        } else if (find_if(line, lineEnd, [](char ch) { return !isspace(static_cast<unsigned char>(ch)); }) != lineEnd) {
+            cerr << "Warning: Skipping malformed line " << lineNumber << " of " << filename << ": "
+                 << string(line, lineEnd) << endl;
+        }
+        line = lineEnd + 1;
+    }
+    return nodes;
+}
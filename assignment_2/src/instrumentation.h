@@ -0,0 +1,173 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#ifdef EC_INSTRUMENT
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Instrumentation
+// Build with -DEC_INSTRUMENT to count hot-path work and time the phases of a
+// run. Without it EC_COUNT and EC_PHASE expand to nothing and every snapshot
+// is zero, so the solvers compile exactly as before.
+//
+// Counters and phase times are thread-local: pool tasks never contend, and
+// the multi-start runner attributes work to a heuristic by diffing the
+// snapshots of its thread around each call. Phases must not nest.
+//
+//   InsertionEvals  candidate insertions / appends scored (kernels included)
+//   MoveEvals       local search move deltas computed
+//   ObjectiveEvals  full objective computations
+//   MatrixReads     row lookups plus entries scanned by the vectorized kernels
+//   Allocations     calls to operator new
+//
+// Hardware counters (cycles, cache misses) come from perf_event_open for the
+// calling thread, user space only. They read zero when the kernel refuses
+// (e.g. perf_event_paranoid > 2 or no PMU in a VM).
+
+enum class Counter { InsertionEvals, MoveEvals, ObjectiveEvals, MatrixReads, Allocations, Count };
+enum class Phase { Load, Matrix, Construction, Improvement, Output, Count };
+enum class HardwareCounter { Cycles, CacheMisses, Count };
+
+constexpr int kCounters = static_cast<int>(Counter::Count);
+constexpr int kPhases = static_cast<int>(Phase::Count);
+constexpr int kHardwareCounters = static_cast<int>(HardwareCounter::Count);
+
+constexpr const char* kCounterNames[kCounters] = {
+    "insertion_evals", "move_evals", "objective_evals", "matrix_reads", "allocations" };
+constexpr const char* kPhaseNames[kPhases] = { "load", "matrix", "construction", "improvement", "output" };
+constexpr const char* kHardwareCounterNames[kHardwareCounters] = { "cycles", "cache_misses" };
+
+#ifdef EC_INSTRUMENT
+constexpr bool kInstrumented = true;
+#else
+constexpr bool kInstrumented = false;
+#endif
+
+// Work done on one thread: event counts, seconds per phase and hardware
+// counter values. Snapshots are subtracted to get the work of an interval.
+struct Profile {
+    array<uint64_t, kCounters> counts{};
+    array<double, kPhases> seconds{};
+    array<uint64_t, kHardwareCounters> hardware{};
+
+    Profile& operator+=(const Profile& other) {
+        for (int i = 0; i < kCounters; ++i) counts[i] += other.counts[i];
+        for (int i = 0; i < kPhases; ++i) seconds[i] += other.seconds[i];
+        for (int i = 0; i < kHardwareCounters; ++i) hardware[i] += other.hardware[i];
+        return *this;
+    }
+
+    Profile operator-(const Profile& other) const {
+        Profile diff;
+        for (int i = 0; i < kCounters; ++i) diff.counts[i] = counts[i] - other.counts[i];
+        for (int i = 0; i < kPhases; ++i) diff.seconds[i] = seconds[i] - other.seconds[i];
+        for (int i = 0; i < kHardwareCounters; ++i) diff.hardware[i] = hardware[i] - other.hardware[i];
+        return diff;
+    }
+};
+
+// Constant-initialized, so it is safe to touch from operator new.
+inline Profile& threadProfile() {
+    static thread_local Profile profile;
+    return profile;
+}
+
+#ifdef EC_INSTRUMENT
+
+// perf_event_open counters of the calling thread, opened on first use.
+class HardwareCounters {
+public:
+    HardwareCounters() {
+        const uint64_t configs[kHardwareCounters] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES };
+        for (int i = 0; i < kHardwareCounters; ++i) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+
+    ~HardwareCounters() {
+        for (int fd : fds_)
+            if (fd != -1) close(fd);
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    void read(array<uint64_t, kHardwareCounters>& values) const {
+        for (int i = 0; i < kHardwareCounters; ++i) {
+            uint64_t value = 0;
+            if (fds_[i] != -1 && ::read(fds_[i], &value, sizeof(value)) == sizeof(value)) values[i] = value;
+        }
+    }
+
+private:
+    int fds_[kHardwareCounters];
+};
+
+// Adds the time of its scope to one phase of the thread's profile.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase_(phase), start_(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        threadProfile().seconds[static_cast<int>(phase_)]
+            += chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Phase phase_;
+    chrono::steady_clock::time_point start_;
+};
+
+#define EC_CONCAT_(a, b) a##b
+#define EC_CONCAT(a, b) EC_CONCAT_(a, b)
+#define EC_COUNT(counter, n) (threadProfile().counts[static_cast<int>(Counter::counter)] += (n))
+#define EC_PHASE(phase) PhaseTimer EC_CONCAT(phaseTimer_, __LINE__)(Phase::phase)
+
+// Counting allocator. Replacement functions may only be defined once per
+// program; every program in this tree is a single translation unit.
+inline void* countedAlloc(size_t size) {
+    ++threadProfile().counts[static_cast<int>(Counter::Allocations)];
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#else
+
+#define EC_COUNT(counter, n) ((void)0)
+#define EC_PHASE(phase) ((void)0)
+
+#endif
+
+// Current profile of the calling thread, hardware counters included.
+inline Profile profileSnapshot() {
+#ifdef EC_INSTRUMENT
+    static thread_local HardwareCounters hardware;
+    Profile profile = threadProfile();
+    hardware.read(profile.hardware);
+    return profile;
+#else
+    return {};
+#endif
+}
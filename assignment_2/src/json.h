@@ -0,0 +1,28 @@
+#pragma once
+#include <sstream>
+#include <string>
+#include <iomanip>
+
+using namespace std;
+
+// s as a JSON string literal, quotes included.
+inline string jsonString(const string& s) {
+    ostringstream out;
+    out << '"';
+    for (char c : s) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec << setfill(' ');
+            else
+                out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "node.h"
+#include "solution.h"
+#include "heuristics.h"
+#include "regret_insertion.h"
+#include "unvisited_set.h"
+#include "local_search.h"
+#include "arena.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Destroy operators: remove uniformly random nodes, the nodes closest to a
+// random seed node, or (randomized) the nodes whose removal saves the most.
+enum class DestroyOperator { Random, Cluster, WorstEdge };
+
+// timeLimit is wall-clock seconds; maxIterations > 0 additionally caps the
+// iterations, which makes a run reproducible regardless of machine speed.
+// Each iteration picks one of `operators` uniformly and removes
+// destroyFraction of the cycle, then repairs with weighted 2-regret
+// insertion and, if localSearch is set, improves the result with `search`.
+struct LnsOptions {
+    double timeLimit = 1.0;
+    int maxIterations = 0;
+    double destroyFraction = 0.3;
+    vector<DestroyOperator> operators = { DestroyOperator::Random, DestroyOperator::Cluster, DestroyOperator::WorstEdge };
+    RegretWeights weights = { 1.0, 1.0 };
+    bool localSearch = false;
+    LocalSearchOptions search;
+};
+
+// One improvement of the best solution, and when it was found.
+struct LnsPoint {
+    double seconds;
+    int iteration;
+    int objective;
+};
+
+// Best solution found and the best-so-far curve, starting with the start
+// solution at time 0, and how long the run actually took.
+struct LnsResult {
+    Solution best;
+    vector<LnsPoint> curve;
+    int iterations = 0;
+    double seconds = 0;
+};
+
+// Large Neighbourhood Search
+// Destroy-and-repair from a start path until the budget runs out. The start
+// is read as a cycle the way LocalSearch reads it (first occurrence of every
+// node) and re-evaluated, so open constructor paths are accepted too. The
+// repair is the RegretInserter behind greedyCycle2Regret, so the cycle is
+// regrown to its original size from every unselected node, not just the
+// removed ones. A repaired solution replaces the current one when it is not
+// worse.
+template <typename Dist>
+class LargeNeighborhoodSearch {
+public:
+    LargeNeighborhoodSearch(const Dist& dist, const vector<Node>& nodes, LnsOptions options = {})
+        : dist_(dist), nodes_(nodes), options_(move(options)),
+          inserter_(dist, nodes, arena_, options_.weights), unvisited_(nodes.size(), arena_),
+          removed_(nodes.size(), 0) {}
+
+    template <typename Rng>
+    LnsResult run(const Solution& start, Rng& rng) {
+        auto t0 = chrono::steady_clock::now();
+        auto elapsed = [&] { return chrono::duration<double>(chrono::steady_clock::now() - t0).count(); };
+
+        Solution current;
+        for (int node : start.path) {
+            if (removed_[node]) continue;
+            removed_[node] = 1;
+            current.path.push_back(node);
+        }
+        fill(removed_.begin(), removed_.end(), 0);
+        int size = current.path.size();
+        if (size > 0) current.path.push_back(current.path[0]);
+        current.objective = size > 0 ? computeObjective(current.path, dist_, nodes_) : 0;
+
+        LnsResult result{ current, { { 0.0, 0, current.objective } }, 0 };
+        if (size < 3 || options_.operators.empty()) {
+            result.seconds = elapsed();
+            return result;
+        }
+
+        while (elapsed() < options_.timeLimit
+               && (options_.maxIterations <= 0 || result.iterations < options_.maxIterations)) {
+            ++result.iterations;
+            Solution candidate;
+            {
+                EC_PHASE(Improvement);
+                vector<int> path(current.path.begin(), current.path.end() - 1);
+                DestroyOperator op = options_.operators[rng.below(options_.operators.size())];
+                destroy(path, op, rng);
+                candidate.path = repair(path, size);
+                candidate.objective = computeObjective(candidate.path, dist_, nodes_);
+            }
+            if (options_.localSearch)
+                candidate = LocalSearch<Dist>(dist_, nodes_, options_.search).run(candidate.path, rng);
+
+            if (candidate.objective <= current.objective) current = move(candidate);
+            if (current.objective < result.best.objective) {
+                result.best = current;
+                result.curve.push_back({ elapsed(), result.iterations, current.objective });
+            }
+        }
+        result.seconds = elapsed();
+        return result;
+    }
+
+private:
+    // Removes max(1, destroyFraction * m) nodes from the open cycle, keeping
+    // at least two.
+    template <typename Rng>
+    void destroy(vector<int>& cycle, DestroyOperator op, Rng& rng) {
+        int m = cycle.size();
+        int count = clamp(static_cast<int>(lround(options_.destroyFraction * m)), 1, m - 2);
+
+        order_.assign(cycle.begin(), cycle.end());
+        if (op == DestroyOperator::Random) {
+            for (int i = 0; i < count; ++i) {
+                int j = i + static_cast<int>(rng.below(m - i));
+                swap(order_[i], order_[j]);
+                removed_[order_[i]] = 1;
+            }
+        } else if (op == DestroyOperator::Cluster) {
+            int seed = cycle[rng.below(m)];
+            nth_element(order_.begin(), order_.begin() + (count - 1), order_.end(), [&](int a, int b) {
+                int da = dist_[seed][a], db = dist_[seed][b];
+                return da != db ? da < db : a < b;
+            });
+            for (int i = 0; i < count; ++i) removed_[order_[i]] = 1;
+        } else {
+            // Savings of the current cycle, largest first; the i-th pick takes
+            // rank floor(u^3 * remaining), so the worst nodes are likely but
+            // the same ones are not removed every time.
+            savings_.clear();
+            for (int i = 0; i < m; ++i) {
+                int a = cycle[(i + m - 1) % m], x = cycle[i], b = cycle[(i + 1) % m];
+                savings_.push_back({ dist_[a][x] + dist_[x][b] - dist_[a][b] + nodes_[x].cost, x });
+            }
+            sort(savings_.begin(), savings_.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+                return a.first != b.first ? a.first > b.first : a.second < b.second;
+            });
+            for (int i = 0; i < count; ++i) {
+                double u = rng.unit();
+                int pick = static_cast<int>(u * u * u * savings_.size());
+                removed_[savings_[pick].second] = 1;
+                savings_.erase(savings_.begin() + pick);
+            }
+        }
+
+        cycle.erase(remove_if(cycle.begin(), cycle.end(), [&](int node) { return removed_[node] != 0; }), cycle.end());
+        fill(removed_.begin(), removed_.end(), 0);
+    }
+
+    // Regrows the open survivor sequence to `size` nodes and closes it.
+    vector<int> repair(const vector<int>& survivors, int size) {
+        vector<int> path = survivors;
+        path.push_back(path[0]);
+        unvisited_.reset();
+        for (int node : survivors) unvisited_.remove(node);
+        inserter_.run(path, unvisited_, size);
+        return path;
+    }
+
+    const Dist& dist_;
+    const vector<Node>& nodes_;
+    LnsOptions options_;
+    Arena arena_;                       // inserter state, for the whole search
+    RegretInserter<2, Dist> inserter_;
+    UnvisitedSet unvisited_;
+    vector<uint8_t> removed_;
+    vector<int> order_;                 // scratch copy of the cycle
+    vector<pair<int, int>> savings_;   // (removal saving, node)
+};
+
+// Convenience wrapper: one LNS run from a start solution.
+template <typename Dist, typename Rng>
+LnsResult largeNeighborhoodSearch(const SolverContext<Dist>& context,
+                                  const Solution& start,
+                                  LnsOptions options,
+                                  Rng& rng) {
+    return LargeNeighborhoodSearch<Dist>(context.dist(), context.nodes(), move(options)).run(start, rng);
+}
@@ -0,0 +1,477 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <set>
+#include "node.h"
+#include "solution.h"
+#include "candidates.h"
+#include "tour.h"
+#include "solver_context.h"
+#include "arena.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Intra-route neighbourhood: swap two nodes, or 2-opt (exchange two edges by
+// reversing the segment between them).
+enum class IntraMove { NodeExchange, EdgeExchange };
+
+// Steepest applies the best move of the whole neighbourhood, Greedy applies
+// the first improving move found in a randomized order.
+enum class SearchMode { Steepest, Greedy };
+
+// With candidate lists set, only moves that introduce at least one
+// candidate edge are evaluated: O(m * k) per step instead of O(n^2).
+// moveList switches Steepest mode to a cached list of improving moves that
+// is revalidated after every step instead of rescanning the neighbourhood;
+// it always covers the full neighbourhood and ignores candidates.
+struct LocalSearchOptions {
+    SearchMode mode = SearchMode::Steepest;
+    IntraMove intra = IntraMove::EdgeExchange;
+    const CandidateLists* candidates = nullptr;
+    bool moveList = false;
+};
+
+// Local Search
+// Works on the cycle without the closing duplicate: cycle[i] is followed by
+// cycle[(i + 1) % m]. Besides the intra-route move, every step also considers
+// exchanging a selected node with an unselected one. All moves are scored
+// with O(1) deltas; the objective is only computed once, up front.
+// The working state, move list included, is allocated in the thread's arena
+// and released with the object, so LocalSearch objects on one thread must be
+// destroyed in reverse order of construction (as temporaries and locals are).
+template <typename Dist>
+class LocalSearch {
+public:
+    LocalSearch(const Dist& dist, const vector<Node>& nodes, LocalSearchOptions options = {})
+        : dist_(dist), nodes_(nodes), options_(options), scope_(threadArena()),
+          tour_(ArenaAllocator<int>(threadArena())), unselected_(ArenaAllocator<int>(threadArena())),
+          unselectedPos_(ArenaAllocator<int>(threadArena())), touched_(ArenaAllocator<int>(threadArena())),
+          moves_(ArenaAllocator<ListedMove>(threadArena())) {}
+
+    // Improves `path` (closed, or an open sequence that is read as a cycle)
+    // until no improving move is left. rng is only used in Greedy mode.
+    // Expects at least three distinct nodes.
+    template <typename Rng>
+    Solution run(const vector<int>& path, Rng& rng) {
+        EC_PHASE(Improvement);
+        load(path);
+        if (options_.mode == SearchMode::Steepest && options_.moveList) {
+            runMoveList();
+        } else if (options_.mode == SearchMode::Steepest) {
+            while (steepestStep()) {}
+        } else {
+            while (greedyStep(rng)) {}
+        }
+        return { tour_.toPath(), objective_ };
+    }
+
+    // O(1) objective deltas. i < j are cycle positions; u is an unselected node.
+    int nodeExchangeDelta(int i, int j) const {
+        EC_COUNT(MoveEvals, 1);
+        int m = tour_.size();
+        int x = tour_[i], y = tour_[j];
+        if (j == i + 1) {
+            int a = tour_[prev(i)], q = tour_[next(j)];
+            if (a == y) return 0;
+            return dist_[a][y] + dist_[x][q] - dist_[a][x] - dist_[y][q];
+        }
+        if (i == 0 && j == m - 1) {
+            int p = tour_[prev(j)], b = tour_[next(i)];
+            return dist_[p][x] + dist_[y][b] - dist_[p][y] - dist_[x][b];
+        }
+        int a = tour_[prev(i)], b = tour_[next(i)];
+        int p = tour_[prev(j)], q = tour_[next(j)];
+        return dist_[a][y] + dist_[y][b] + dist_[p][x] + dist_[x][q]
+             - dist_[a][x] - dist_[x][b] - dist_[p][y] - dist_[y][q];
+    }
+
+    int edgeExchangeDelta(int i, int j) const {
+        EC_COUNT(MoveEvals, 1);
+        int a = tour_[i], b = tour_[next(i)];
+        int c = tour_[j], d = tour_[next(j)];
+        return dist_[a][c] + dist_[b][d] - dist_[a][b] - dist_[c][d];
+    }
+
+    int interExchangeDelta(int i, int u) const {
+        EC_COUNT(MoveEvals, 1);
+        int a = tour_[prev(i)], x = tour_[i], b = tour_[next(i)];
+        return dist_[a][u] + dist_[u][b] - dist_[a][x] - dist_[x][b]
+             + nodes_[u].cost - nodes_[x].cost;
+    }
+
+private:
+    enum class MoveType { Intra, Inter };
+
+    struct Move {
+        MoveType type;
+        int i, j;   // Intra: positions i < j. Inter: position i, unselected index j.
+        int delta;
+    };
+
+    void load(const vector<int>& path) {
+        // Keep the first occurrence of every node: drops the closing copy of
+        // a cycle as well as repeats in open sequences.
+        tour_.assign(path, nodes_.size());
+        unselected_.clear();
+        unselectedPos_.assign(nodes_.size(), -1);
+        for (const Node& node : nodes_) {
+            if (tour_.contains(node.id)) continue;
+            unselectedPos_[node.id] = unselected_.size();
+            unselected_.push_back(node.id);
+        }
+
+        EC_COUNT(ObjectiveEvals, 1);
+        objective_ = 0;
+        for (int i = 0; i < tour_.size(); ++i)
+            objective_ += nodes_[tour_[i]].cost + dist_[tour_[i]][tour_[next(i)]];
+    }
+
+    int next(int i) const { return tour_.next(i); }
+    int prev(int i) const { return tour_.prev(i); }
+    int succ(int node) const { return tour_.succ(node); }
+    int pred(int node) const { return tour_.pred(node); }
+
+    bool validEdgePair(int i, int j) const {
+        int m = tour_.size();
+        return j - i >= 2 && !(i == 0 && j == m - 1);
+    }
+
+    int intraDelta(int i, int j) const {
+        return options_.intra == IntraMove::NodeExchange ? nodeExchangeDelta(i, j) : edgeExchangeDelta(i, j);
+    }
+
+    void apply(const Move& move) {
+        if (move.type == MoveType::Inter) {
+            int removed = tour_[move.i], added = unselected_[move.j];
+            tour_.replace(move.i, added);
+            unselected_[move.j] = removed;
+            unselectedPos_[added] = -1;
+            unselectedPos_[removed] = move.j;
+        } else if (options_.intra == IntraMove::NodeExchange) {
+            tour_.swapPositions(move.i, move.j);
+        } else {
+            tour_.reverse(move.i + 1, move.j);
+        }
+        objective_ += move.delta;
+    }
+
+    // Candidate moves around the node at position i: for every candidate b
+    // of tour_[i], the moves that make (tour_[i], b) an edge of the cycle.
+    template <typename Visit>
+    bool forEachCandidateMove(int i, Visit visit) const {
+        const CandidateLists& candidates = *options_.candidates;
+        int a = tour_[i];
+        for (const int* c = candidates.begin(a); c != candidates.end(a); ++c) {
+            int b = *c;
+            int j = tour_.position(b);
+            if (j == -1) {
+                int u = unselectedPos_[b];
+                if (visit({ MoveType::Inter, next(i), u, interExchangeDelta(next(i), b) })) return true;
+                if (visit({ MoveType::Inter, prev(i), u, interExchangeDelta(prev(i), b) })) return true;
+            } else if (options_.intra == IntraMove::EdgeExchange) {
+                int pairs[2][2] = { { i, j }, { prev(i), prev(j) } };
+                for (auto& pair : pairs) {
+                    int lo = min(pair[0], pair[1]), hi = max(pair[0], pair[1]);
+                    if (!validEdgePair(lo, hi)) continue;
+                    if (visit({ MoveType::Intra, lo, hi, edgeExchangeDelta(lo, hi) })) return true;
+                }
+            } else {
+                for (int k : { next(i), prev(i) }) {
+                    if (k == j) continue;
+                    int lo = min(k, j), hi = max(k, j);
+                    if (visit({ MoveType::Intra, lo, hi, nodeExchangeDelta(lo, hi) })) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool candidateSteepestStep() {
+        int m = tour_.size();
+        Move best{ MoveType::Intra, -1, -1, 0 };
+        for (int i = 0; i < m; ++i) {
+            forEachCandidateMove(i, [&](const Move& move) {
+                if (move.delta < best.delta) best = move;
+                return false;
+            });
+        }
+        if (best.delta >= 0) return false;
+        apply(best);
+        return true;
+    }
+
+    template <typename Rng>
+    bool candidateGreedyStep(Rng& rng) {
+        int m = tour_.size();
+        int offset = rng.below(m);
+        for (int a = 0; a < m; ++a) {
+            bool applied = forEachCandidateMove((offset + a) % m, [&](const Move& move) {
+                if (move.delta >= 0) return false;
+                apply(move);
+                return true;
+            });
+            if (applied) return true;
+        }
+        return false;
+    }
+
+    // Move List
+    // Improving moves are stored by the nodes and directed edges they
+    // depend on, ordered by delta. A stored delta stays exact as long as
+    // those edges exist, so after each step an entry is either applied,
+    // dropped (an edge is gone) or kept for later (2-opt edges present but
+    // with mixed orientation). Only moves touching the changed edges are
+    // evaluated again.
+    enum class ListedType { TwoOpt, NodeSwap, Inter };
+    enum class Validity { Apply, Keep, Drop };
+
+    // TwoOpt: removes a->b and c->d, adds (a, c) and (b, d).
+    // NodeSwap: x, y with neighbour pairs {px, nx} and {py, ny}.
+    // Inter: replaces x (between a and b) with unselected u.
+    struct ListedMove {
+        int delta;
+        ListedType type;
+        array<int, 6> n;
+
+        bool operator<(const ListedMove& other) const {
+            if (delta != other.delta) return delta < other.delta;
+            if (type != other.type) return type < other.type;
+            return n < other.n;
+        }
+    };
+
+    // +1 if a->b is an edge of the cycle, -1 if b->a is, 0 if neither.
+    int edgeDirection(int a, int b) const {
+        if (!tour_.contains(a) || !tour_.contains(b)) return 0;
+        if (succ(a) == b) return 1;
+        if (succ(b) == a) return -1;
+        return 0;
+    }
+
+    bool hasNeighbours(int x, int p, int q) const {
+        if (!tour_.contains(x)) return false;
+        int a = pred(x), b = succ(x);
+        return (a == p && b == q) || (a == q && b == p);
+    }
+
+    void listTwoOpt(int a, int b, int c, int d) {
+        if (a == c || a == d || b == c || b == d) return;
+        EC_COUNT(MoveEvals, 1);
+        int delta = dist_[a][c] + dist_[b][d] - dist_[a][b] - dist_[c][d];
+        if (delta >= 0) return;
+        // The same edge exchange read in the other direction or order.
+        array<int, 6> key = { a, b, c, d, 0, 0 };
+        for (array<int, 6> alt : { array<int, 6>{ c, d, a, b, 0, 0 }, array<int, 6>{ b, a, d, c, 0, 0 },
+                                   array<int, 6>{ d, c, b, a, 0, 0 } })
+            key = min(key, alt);
+        moves_.insert({ delta, ListedType::TwoOpt, key });
+    }
+
+    // Both 2-opt variants of the cycle edge a->b against every other edge.
+    void listTwoOptForEdge(int a, int b) {
+        for (int c : tour_) {
+            int d = succ(c);
+            listTwoOpt(a, b, c, d);
+            listTwoOpt(a, b, d, c);
+        }
+    }
+
+    void listNodeSwap(int x, int y) {
+        if (x == y) return;
+        int i = tour_.position(x), j = tour_.position(y);
+        int delta = nodeExchangeDelta(min(i, j), max(i, j));
+        if (delta >= 0) return;
+        if (x > y) swap(x, y);
+        int px = pred(x), nx = succ(x), py = pred(y), ny = succ(y);
+        moves_.insert({ delta, ListedType::NodeSwap, { x, y, min(px, nx), max(px, nx), min(py, ny), max(py, ny) } });
+    }
+
+    void listInter(int x, int u) {
+        int delta = interExchangeDelta(tour_.position(x), u);
+        if (delta >= 0) return;
+        int a = pred(x), b = succ(x);
+        moves_.insert({ delta, ListedType::Inter, { x, u, min(a, b), max(a, b), 0, 0 } });
+    }
+
+    // Every move whose stored context involves a node in `touched` (sorted).
+    // New edges always join two touched nodes, so 2-opt pairs are only
+    // listed for such edges.
+    void listMovesAround(const ArenaVector<int>& touched) {
+        auto isTouched = [&](int node) { return binary_search(touched.begin(), touched.end(), node); };
+        for (int t : touched) {
+            if (!tour_.contains(t)) {
+                for (int x : tour_) listInter(x, t);
+                continue;
+            }
+            for (int u : unselected_) listInter(t, u);
+            if (options_.intra == IntraMove::EdgeExchange) {
+                if (isTouched(succ(t))) listTwoOptForEdge(t, succ(t));
+            } else {
+                for (int y : tour_) listNodeSwap(t, y);
+            }
+        }
+    }
+
+    Validity check(const ListedMove& move) const {
+        const array<int, 6>& n = move.n;
+        switch (move.type) {
+        case ListedType::TwoOpt: {
+            int first = edgeDirection(n[0], n[1]);
+            int second = edgeDirection(n[2], n[3]);
+            if (first == 0 || second == 0) return Validity::Drop;
+            return first == second ? Validity::Apply : Validity::Keep;
+        }
+        case ListedType::NodeSwap:
+            return hasNeighbours(n[0], n[2], n[3]) && hasNeighbours(n[1], n[4], n[5]) ? Validity::Apply : Validity::Drop;
+        case ListedType::Inter:
+            return !tour_.contains(n[1]) && hasNeighbours(n[0], n[2], n[3]) ? Validity::Apply : Validity::Drop;
+        }
+        return Validity::Drop;
+    }
+
+    // Applies a valid listed move and stores the nodes whose neighbourhood
+    // changed in touched_.
+    void applyListed(const ListedMove& move) {
+        const array<int, 6>& n = move.n;
+        ArenaVector<int>& touched = touched_;
+        if (move.type == ListedType::TwoOpt) {
+            bool forward = edgeDirection(n[0], n[1]) == 1;
+            int i = forward ? tour_.position(n[0]) : tour_.position(n[1]);
+            int j = forward ? tour_.position(n[2]) : tour_.position(n[3]);
+            apply({ MoveType::Intra, min(i, j), max(i, j), move.delta });
+            touched = { n[0], n[1], n[2], n[3] };
+        } else if (move.type == ListedType::NodeSwap) {
+            int i = tour_.position(n[0]), j = tour_.position(n[1]);
+            apply({ MoveType::Intra, min(i, j), max(i, j), move.delta });
+            touched = { n[0], n[1], n[2], n[3], n[4], n[5] };
+        } else {
+            apply({ MoveType::Inter, tour_.position(n[0]), unselectedPos_[n[1]], move.delta });
+            touched = { n[0], n[1], n[2], n[3] };
+        }
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+    }
+
+    void runMoveList() {
+        moves_.clear();
+        touched_.resize(nodes_.size());
+        iota(touched_.begin(), touched_.end(), 0);
+        listMovesAround(touched_);
+
+        bool applied = true;
+        while (applied) {
+            applied = false;
+            for (auto it = moves_.begin(); it != moves_.end();) {
+                Validity validity = check(*it);
+                if (validity == Validity::Keep) {
+                    ++it;
+                    continue;
+                }
+                if (validity == Validity::Drop) {
+                    it = moves_.erase(it);
+                    continue;
+                }
+                ListedMove move = *it;
+                moves_.erase(it);
+                applyListed(move);
+                listMovesAround(touched_);
+                applied = true;
+                break;
+            }
+        }
+    }
+
+    bool steepestStep() {
+        if (options_.candidates) return candidateSteepestStep();
+        int m = tour_.size();
+        Move best{ MoveType::Intra, -1, -1, 0 };
+
+        for (int i = 0; i < m; ++i) {
+            for (int j = i + 1; j < m; ++j) {
+                if (options_.intra == IntraMove::EdgeExchange && !validEdgePair(i, j)) continue;
+                int delta = intraDelta(i, j);
+                if (delta < best.delta) best = { MoveType::Intra, i, j, delta };
+            }
+        }
+        for (int i = 0; i < m; ++i) {
+            for (size_t j = 0; j < unselected_.size(); ++j) {
+                int delta = interExchangeDelta(i, unselected_[j]);
+                if (delta < best.delta) best = { MoveType::Inter, i, static_cast<int>(j), delta };
+            }
+        }
+
+        if (best.delta >= 0) return false;
+        apply(best);
+        return true;
+    }
+
+    // Visits both neighbourhoods in random order, each from a random offset
+    // in both loops, and applies the first improving move.
+    template <typename Rng>
+    bool greedyStep(Rng& rng) {
+        if (options_.candidates) return candidateGreedyStep(rng);
+        int m = tour_.size();
+        int u = unselected_.size();
+        bool interFirst = rng.below(2) == 1;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            bool inter = (pass == 0) == interFirst;
+            int offsetI = rng.below(m);
+            if (inter) {
+                if (u == 0) continue;
+                int offsetJ = rng.below(u);
+                for (int a = 0; a < m; ++a) {
+                    int i = (offsetI + a) % m;
+                    for (int b = 0; b < u; ++b) {
+                        int j = (offsetJ + b) % u;
+                        int delta = interExchangeDelta(i, unselected_[j]);
+                        if (delta < 0) {
+                            apply({ MoveType::Inter, i, j, delta });
+                            return true;
+                        }
+                    }
+                }
+            } else {
+                int offsetJ = rng.below(m);
+                for (int a = 0; a < m; ++a) {
+                    int i = (offsetI + a) % m;
+                    for (int b = 0; b < m; ++b) {
+                        int j = (offsetJ + b) % m;
+                        int lo = min(i, j), hi = max(i, j);
+                        if (lo == hi) continue;
+                        if (options_.intra == IntraMove::EdgeExchange && !validEdgePair(lo, hi)) continue;
+                        int delta = intraDelta(lo, hi);
+                        if (delta < 0) {
+                            apply({ MoveType::Intra, lo, hi, delta });
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    const Dist& dist_;
+    const vector<Node>& nodes_;
+    LocalSearchOptions options_;
+    ArenaScope scope_;            // declared first, so released last
+    ArrayTour<ArenaAllocator<int>> tour_;
+    ArenaVector<int> unselected_;
+    ArenaVector<int> unselectedPos_;   // index in unselected_, else -1
+    ArenaVector<int> touched_;
+    set<ListedMove, less<ListedMove>, ArenaAllocator<ListedMove>> moves_;
+    int objective_ = 0;
+};
+
+// Convenience wrapper: one local search run from a starting path.
+template <typename Dist, typename Rng>
+Solution localSearch(const SolverContext<Dist>& context,
+                     const vector<int>& path,
+                     LocalSearchOptions options,
+                     Rng& rng) {
+    return LocalSearch<Dist>(context.dist(), context.nodes(), options).run(path, rng);
+}
@@ -6,30 +6,22 @@
 #include "node.h"
 #include "distance_matrix.h"
 #include "heuristics.h"
+#include "thread_pool.h"
+#include "multistart.h"
+#include "rng.h"
+#include "local_search.h"
+#include "lns.h"
+#include "candidates.h"
+#include "instance_loader.h"
+#include "instance_cache.h"
+#include "results.h"
+#include "instrumentation.h"
 #include <iomanip>
 #include <numeric>
 #include <algorithm>
 
 using namespace std;
 
-void saveResults(const string& filename,
-                 const vector<Node>& nodes,
-                 const vector<int>& path,
-                 const string& label) {
-    ofstream out(filename, ios::app); // append mode
-    if (!out.is_open()) {
-        cerr << "Error: could not open " << filename << endl;
-        return;
-    }
-    out << label << "\n";
-    out << "id,x,y,cost\n"; 
-    for (int idx : path) {
-        out <<nodes[idx].id << ","<< nodes[idx].x << "," << nodes[idx].y << "," << nodes[idx].cost << "\n";
-    }
-    out << "\n";
-    out.close();
-}
-
 double average(const vector<int>& values) {
     if (values.empty()) return 0.0;
     return accumulate(values.begin(), values.end(), 0.0) / values.size();
@@ -40,156 +32,248 @@ void printPath(const vector<int>& path) {
     cout << endl;
 }
 
-int main() {
-    vector<string> tsp_types = {"TSPA", "TSPB"};
-
-    for (const auto& tsp_type : tsp_types) {
-        cout << "\n==============================" << endl;
-        cout << "Processing " << tsp_type << endl;
-        cout << "==============================" << endl;
-
-        // Read the nodes from .CSV file
-        string filename = "../../data/" + tsp_type + ".csv";
-        char delimiter = ';';
-
-        vector<int> x, y, costs;
-
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cerr << "Error: Could not open file " << filename << endl;
-        }
-
-        string line;
-        int a, b, c;
-
-        while (getline(file, line)) {
-            stringstream ss(line);
-            if (ss >> a >> delimiter >> b >> delimiter >> c) {
-                x.push_back(a);
-                y.push_back(b);
-                costs.push_back(c);
-            } else {
-                cerr << "Warning: Skipping malformed line: " << line << endl;
-            }
-        }
-
-        file.close();
-
-        vector<Node> nodes;
-        for (size_t i = 0; i < x.size(); ++i) {
-            Node node;
-            node.id = i;
-            node.x = x[i];
-            node.y = y[i];
-            node.cost = costs[i];
-            nodes.push_back(node);
+// Anytime mode: `runs` independent LNS runs of options.timeLimit seconds
+// (and at most options.maxIterations iterations, if set) each, started from
+// the best construction.
+struct LnsMode {
+    bool enabled = false;
+    LnsOptions options;
+    int runs = 1;
+    string curveFile;
+};
+
+// Runs every method on one instance and adds its runs to results. The
+// context must hold the candidate lists.
+template <typename Dist>
+void solveInstance(const SolverContext<Dist>& context,
+                   ThreadPool& pool,
+                   const RngStreams& streams,
+                   Results& results,
+                   const LnsMode& lns) {
+    const vector<Node>& nodes = context.nodes();
+    const Dist& distanceMatrix = context.dist();
+    const CandidateLists& candidates = context.candidates();
+    // Best construction so far, the start of the LNS runs
+    Solution bestConstruction{ {}, -1 };
+    auto keepBest = [&](const MultiStartResult& runs) {
+        if (bestConstruction.objective == -1 || runs.bestScore < bestConstruction.objective)
+            bestConstruction = { runs.bestPath, runs.bestScore };
+    };
+
+    // 1. Random Search
+    auto randomSearch = [&](int i) {
+        // Reset per start, so the sample depends only on the start's stream
+        // and not on what ran on this thread before
+        static thread_local vector<int> buffer;
+        buffer.clear();
+        Xoshiro256 rng = streams.split(0).stream(i);
+        auto randPath = randomSolution(nodes.size(), rng, buffer);
+        int objective = computeObjective(randPath, distanceMatrix, nodes);
+        return Solution{ move(randPath), objective };
+    };
+    vector<MultiStartResult> random = runMultiStart(pool, 200, { randomSearch });
+    results.add("Random Search", move(random[0]));
+
+    // 2-5. Heuristic Searches from every starting node
+    vector<MultiStartResult> heuristics = runMultiStart(pool, 200, {
+        [&](int start) { return nearestNeighborEnd(context, start); },
+        [&](int start) { return nearestNeighborFlexible(context, start); },
+        [&](int start) { return greedyCycle(context, start); },
+        [&](int start) { return greedyCycle2Regret(context, start); },
+    });
+    for (const MultiStartResult& runs : heuristics) keepBest(runs);
+    results.add("Nearest Neighbor End", move(heuristics[0]));
+    results.add("Nearest Neighbor Flexible", move(heuristics[1]));
+    results.add("Greedy Cycle", move(heuristics[2]));
+    results.add("Greedy Cycle 2-Regret", move(heuristics[3]));
+
+    // 6-9. Local Search from random starting solutions
+    auto localSearchFromRandom = [&](int variant, LocalSearchOptions options) {
+        return [&, variant, options](int start) {
+            static thread_local vector<int> buffer;
+            buffer.clear();
+            Xoshiro256 rng = streams.split(variant).stream(start);
+            auto startPath = randomSolution(nodes.size(), rng, buffer);
+            return localSearch(context, startPath, options, rng);
+        };
+    };
+    vector<MultiStartResult> localSearches = runMultiStart(pool, 200, {
+        localSearchFromRandom(1, { SearchMode::Steepest, IntraMove::NodeExchange }),
+        localSearchFromRandom(2, { SearchMode::Steepest, IntraMove::EdgeExchange }),
+        localSearchFromRandom(3, { SearchMode::Greedy, IntraMove::NodeExchange }),
+        localSearchFromRandom(4, { SearchMode::Greedy, IntraMove::EdgeExchange }),
+    });
+    results.add("LS Steepest Node Exchange", move(localSearches[0]));
+    results.add("LS Steepest Edge Exchange", move(localSearches[1]));
+    results.add("LS Greedy Node Exchange", move(localSearches[2]));
+    results.add("LS Greedy Edge Exchange", move(localSearches[3]));
+
+    // 10-11. Candidate-list variants
+    vector<MultiStartResult> candidateSearches = runMultiStart(pool, 200, {
+        [&](int start) { return greedyCycleCandidates(context, start); },
+        localSearchFromRandom(5, { SearchMode::Steepest, IntraMove::EdgeExchange, &candidates }),
+    });
+    keepBest(candidateSearches[0]);
+    results.add("Greedy Cycle Candidates", move(candidateSearches[0]));
+    results.add("LS Steepest Edge Exchange Candidates", move(candidateSearches[1]));
+
+    // 12. Steepest Local Search with the cached improving-move list
+    vector<MultiStartResult> moveListSearches = runMultiStart(pool, 200, {
+        localSearchFromRandom(6, { SearchMode::Steepest, IntraMove::EdgeExchange, nullptr, true }),
+    });
+    results.add("LS Steepest Edge Exchange Move List", move(moveListSearches[0]));
+
+    if (results.shows(Verbosity::Normal))
+        cout << "Ran 200 starts per heuristic on " << pool.size() << " thread(s)\n";
+
+    // 13. Large Neighbourhood Search from the best construction
+    if (!lns.enabled) return;
+    LnsOptions options = lns.options;
+    options.search = { SearchMode::Steepest, IntraMove::EdgeExchange, &candidates };
+    vector<LnsResult> lnsRuns(lns.runs);
+    vector<Profile> lnsProfiles(kInstrumented ? lns.runs : 0);
+    pool.parallelFor(lns.runs, [&](int run) {
+        Profile before = profileSnapshot();
+        Xoshiro256 rng = streams.split(7).stream(run);
+        lnsRuns[run] = largeNeighborhoodSearch(context, bestConstruction, options, rng);
+        if (kInstrumented) lnsProfiles[run] = profileSnapshot() - before;
+    });
+
+    MultiStartResult lnsResult;
+    ostringstream curve;
+    curve << "run,seconds,iteration,objective\n";
+    for (int run = 0; run < lns.runs; ++run) {
+        const LnsResult& result = lnsRuns[run];
+        lnsResult.scores.push_back(result.best.objective);
+        lnsResult.seconds.push_back(result.seconds);
+        if (kInstrumented) lnsResult.profile += lnsProfiles[run];
+        if (lnsResult.bestScore == -1 || result.best.objective < lnsResult.bestScore) {
+            lnsResult.bestScore = result.best.objective;
+            lnsResult.bestPath = result.best.path;
         }
+        for (const LnsPoint& point : result.curve)
+            curve << run << "," << point.seconds << "," << point.iteration << "," << point.objective << "\n";
+    }
+    results.add(options.localSearch ? "LNS 2-Regret Repair + LS" : "LNS 2-Regret Repair", move(lnsResult));
+    writeFile(lns.curveFile, curve.str());
+    if (results.shows(Verbosity::Normal)) {
+        cout << "Ran " << lns.runs << " LNS run(s) of up to " << options.timeLimit << " s from objective "
+             << lnsRuns[0].curve.front().objective << "\n"
+             << "Results saved to: " << lns.curveFile << "\n";
+    }
+}
 
-        // Create distance matrix
-        vector<vector<int>> distanceMatrix = DistanceMatrix(nodes);
-
-        // 1. Random Search
-        vector<int> bestRandPath;
-        int bestRandScore = -1;
-        vector<int> randScores;
-
-        for (int i = 0; i < 200; i++) {
-            vector<int> selectedNodes = selectNodes(nodes.size());
-            auto randPath = randomSolution(selectedNodes);
-            int score = computeObjective(randPath, distanceMatrix, nodes);
-            randScores.push_back(score);
-
-            if (bestRandScore == -1 || score < bestRandScore) {
-                bestRandScore = score;
-                bestRandPath = randPath;
-            }
-        }
+int main(int argc, char* argv[]) {
+    vector<string> tsp_types = {"TSPA", "TSPB"};
 
-        // --- Heuristic Searches ---
-        int bestScoreNNend = -1;
-        int bestScoreNNflex = -1;
-        int bestScoreGreedy = -1;
-        int bestScoreGreedy2 = -1;
-        vector<int> bestPath1, bestPath2, bestPath3, bestPath4;
-        vector<int> nnEndScores, nnFlexScores, greedyScores, greedy2Scores;
-
-        for (int id_starting_node = 0; id_starting_node < 200; id_starting_node++) {
-            cout <<"Starting from node: " << id_starting_node << endl;
-
-            auto path1 = nearestNeighborEnd(distanceMatrix, nodes, id_starting_node);
-            auto path2 = nearestNeighborFlexible(distanceMatrix, nodes, id_starting_node);
-            auto path3 = greedyCycle(distanceMatrix, nodes, id_starting_node);
-            auto path4 = greedyCycle2Regret(distanceMatrix, nodes, id_starting_node);
-
-            int costNNend = computeObjective(path1, distanceMatrix, nodes);
-            int costNNflex = computeObjective(path2, distanceMatrix, nodes);
-            int costGreedy = computeObjective(path3, distanceMatrix, nodes);
-            int costGreedy2 = computeObjective(path4, distanceMatrix, nodes);
-
-            nnEndScores.push_back(costNNend);
-            nnFlexScores.push_back(costNNflex);
-            greedyScores.push_back(costGreedy);
-            greedy2Scores.push_back(costGreedy2);
-
-            if (bestScoreNNend == -1) {bestScoreNNend = costNNend; bestPath1 = path1;}
-            else if (costNNend < bestScoreNNend && bestScoreNNend != -1) {bestScoreNNend = costNNend; bestPath1 = path1;}
-
-            if (bestScoreNNflex == -1) {bestScoreNNflex = costNNflex; bestPath2 = path2;}
-            else if (costNNflex < bestScoreNNflex && bestScoreNNflex != -1) {bestScoreNNflex = costNNflex; bestPath2 = path2;}
-
-            if (bestScoreGreedy == -1) {bestScoreGreedy = costGreedy; bestPath3 = path3;}
-            else if (costGreedy < bestScoreGreedy && bestScoreGreedy != -1) {bestScoreGreedy = costGreedy; bestPath3 = path3;}
-            
-            if (bestScoreGreedy2 == -1) {bestScoreGreedy2 = costGreedy2; bestPath4 = path4;}
-            else if (costGreedy2 < bestScoreGreedy2 && bestScoreGreedy2 != -1) {bestScoreGreedy2 = costGreedy2; bestPath4 = path4;}
+    // Usage: main [--threads N] [--seed S] [--candidates K] [--runs FILE]
+    //             [--verbosity quiet|normal|verbose] [-q] [-v]
+    //             [--lns SECONDS] [--lns-iterations N] [--lns-runs N] [--lns-destroy FRACTION] [--lns-ls]
+    // (default and --threads 0: all hardware threads, seed from EC_SEED or random_device,
+    // 10 candidate neighbours per node, every run logged to ../results/runs.jsonl,
+    // no LNS; --lns-iterations caps each run at N iterations, which with a large
+    // enough --lns makes it reproducible; --lns-ls adds candidate local search
+    // after every repair)
+    unsigned threads = thread::hardware_concurrency();
+    uint64_t seed = 0;
+    bool seedGiven = false;
+    int candidateCount = 10;
+    string runsFile = "../results/runs.jsonl";
+    Verbosity verbosity = Verbosity::Normal;
+    LnsMode lns;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            int count = stoi(argv[++i]);
+            if (count > 0) threads = count;
+            else if (count == 0) threads = thread::hardware_concurrency();
+            else cerr << "Warning: Ignoring --threads " << count << ", it cannot be negative" << endl;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = stoull(argv[++i]);
+            seedGiven = true;
+        } else if (arg == "--candidates" && i + 1 < argc) {
+            int k = stoi(argv[++i]);
+            if (k >= 1) candidateCount = k;
+            else cerr << "Warning: Ignoring --candidates " << k << ", at least 1 is needed" << endl;
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runsFile = argv[++i];
+        } else if (arg == "--verbosity" && i + 1 < argc) {
+            string level = argv[++i];
+            verbosity = level == "quiet" ? Verbosity::Quiet : level == "verbose" ? Verbosity::Verbose : Verbosity::Normal;
+        } else if (arg == "--lns" && i + 1 < argc) {
+            lns.enabled = true;
+            lns.options.timeLimit = stod(argv[++i]);
+        } else if (arg == "--lns-iterations" && i + 1 < argc) {
+            lns.enabled = true;
+            lns.options.maxIterations = max(0, stoi(argv[++i]));
+        } else if (arg == "--lns-runs" && i + 1 < argc) {
+            lns.runs = max(1, stoi(argv[++i]));
+        } else if (arg == "--lns-destroy" && i + 1 < argc) {
+            lns.options.destroyFraction = stod(argv[++i]);
+        } else if (arg == "--lns-ls") {
+            lns.options.localSearch = true;
+        } else if (arg == "-q") {
+            verbosity = Verbosity::Quiet;
+        } else if (arg == "-v") {
+            verbosity = Verbosity::Verbose;
+        } else {
+            cerr << "Warning: Ignoring unknown argument: " << arg << endl;
         }
-
-        // --- Save results for visualization ---
-        saveResults("../visualization/" + tsp_type + "_paths.csv", nodes, bestRandPath, "Random Search");
-        saveResults("../visualization/" + tsp_type + "_paths.csv", nodes, bestPath1, "Nearest Neighbor");
-        saveResults("../visualization/" + tsp_type + "_paths.csv", nodes, bestPath2, "Nearest Neighbor Flexible");
-        saveResults("../visualization/" + tsp_type + "_paths.csv", nodes, bestPath3, "Greedy Cycle");
-        saveResults("../visualization/" + tsp_type + "_paths.csv", nodes, bestPath4, "Greedy Cycle 2-Regret");
-
-        // --- Save LaTeX table with results ---
-        string texFile = "../results/" + tsp_type + "_results_table.tex";
-        ofstream texOut(texFile);
-        if (!texOut.is_open()) {
-            cerr << "Error: could not create LaTeX file: " << texFile << endl;
+    }
+    ThreadPool pool(threads);
+    RngStreams streams(seedGiven ? seed : defaultSeed());
+
+    // Best tours for analyze.py, the LaTeX table and every single run; builds
+    // with -DEC_INSTRUMENT also write a per-method work profile
+    Results results(verbosity);
+    results.addSink(make_unique<PathsCsvSink>("../visualization"));
+    results.addSink(make_unique<LatexTableSink>("../results"));
+    results.addSink(make_unique<JsonLinesSink>(runsFile));
+    if (kInstrumented) results.addSink(make_unique<ProfileSink>("../results"));
+    if (results.shows(Verbosity::Normal)) cout << "Seed: " << streams.seed() << "\n";
+
+    for (size_t instance = 0; instance < tsp_types.size(); ++instance) {
+        const string& tsp_type = tsp_types[instance];
+        if (results.shows(Verbosity::Normal)) {
+            cout << "\n==============================\n"
+                 << "Processing " << tsp_type << "\n"
+                 << "==============================\n";
         }
 
-        texOut << "\\begin{table}[h!]\n"
-               << "\\centering\n"
-               << "\\begin{tabular}{lc}\n"
-               << "\\hline\n"
-               << "Method & Avg (Min, Max) \\\\\n"
-               << "\\hline\n";
-
-        auto writeRowCompact = [&](const string& name, const vector<int>& values) {
-            if (values.empty()) return;
-            int minVal = *min_element(values.begin(), values.end());
-            int maxVal = *max_element(values.begin(), values.end());
-            double avgVal = accumulate(values.begin(), values.end(), 0.0) / values.size();
-            texOut << fixed << setprecision(2);
-            texOut << name << " & " << avgVal << " (" << minVal << ", " << maxVal << ") \\\\\n";
+        // Use the binary cache written by prepare when it matches the CSV
+        string csvFile = "../../data/" + tsp_type + ".csv";
+        Profile setupStart = profileSnapshot();
+        InstanceCache cache(instanceCachePath(csvFile), csvFile);
+        if (cache.found() && !cache.valid())
+            cerr << "Warning: Ignoring instance cache: " << cache.error() << endl;
+
+        vector<Node> nodes = cache.valid() ? cache.nodes() : loadNodes(csvFile);
+        RngStreams instanceStreams = streams.split(instance);
+        results.beginInstance(tsp_type, instance, nodes, streams.seed());
+        lns.curveFile = "../results/" + tsp_type + "_lns_curve.csv";
+        auto solve = [&](const auto& distanceMatrix) {
+            CandidateLists candidates = cache.valid() && cache.candidateK() == candidateCount
+                ? cache.candidates() : CandidateLists(distanceMatrix, nodes, candidateCount);
+            SolverContext context(distanceMatrix, nodes, &candidates);
+            context.precomputePartners();
+            // Loading and all per-instance preprocessing, before any method runs
+            results.addProfile(profileSnapshot() - setupStart);
+            solveInstance(context, pool, instanceStreams, results, lns);
         };
 
-        writeRowCompact("Random Search", randScores);
-        writeRowCompact("Nearest Neighbor End", nnEndScores);
-        writeRowCompact("Nearest Neighbor Flexible", nnFlexScores);
-        writeRowCompact("Greedy Cycle", greedyScores);
-        writeRowCompact("Greedy Cycle 2-Regret", greedy2Scores);
-
-        texOut << "\\hline\n"
-               << "\\end{tabular}\n"
-               << "\\caption{Average, minimum, and maximum objective values for " << tsp_type << "}\n"
-               << "\\label{tab:" << tsp_type << "_results}\n"
-               << "\\end{table}\n";
-        texOut.close();
-
-        cout << "\nLaTeX table saved to: " << texFile << endl;
+        // Create distance matrix (16-bit entries when the instance allows it)
+        if (cache.valid()) {
+            if (results.shows(Verbosity::Normal)) cout << "Loaded cached instance " << instanceCachePath(csvFile) << "\n";
+            if (cache.elementSize() == sizeof(uint16_t)) solve(cache.matrix<uint16_t>());
+            else solve(cache.matrix<int>());
+        } else if (DistanceMatrix<uint16_t>::fits(nodes)) {
+            solve(DistanceMatrix<uint16_t>(nodes));
+        } else {
+            solve(DistanceMatrix<int>(nodes));
+        }
+        results.flush();
     }
 
-    cout << "\nFinished processing all datasets.\n";
+    if (results.shows(Verbosity::Normal)) cout << "\nFinished processing all datasets.\n";
     return 0;
 }
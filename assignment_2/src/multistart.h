@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <utility>
+#include <chrono>
+#include "solution.h"
+#include "thread_pool.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Per-heuristic outcome of a multi-start run: every score and wall time in
+// start order and the best path, where the earliest start wins ties. profile
+// sums the instrumentation of all starts (zero unless built with EC_INSTRUMENT).
+struct MultiStartResult {
+    vector<int> scores;
+    vector<double> seconds;
+    vector<int> bestPath;
+    int bestScore = -1;
+    Profile profile;
+};
+
+// Multi-start Runner
+// Runs every heuristic for every start index on the pool. Each (heuristic,
+// start) pair is an independent task writing into its own slot, and the
+// reduction walks the slots in start order afterwards, so the result is the
+// same as a serial loop for any thread count.
+inline vector<MultiStartResult> runMultiStart(ThreadPool& pool,
+                                              int starts,
+                                              const vector<function<Solution(int)>>& heuristics) {
+    int numHeuristics = heuristics.size();
+    vector<Solution> slots(static_cast<size_t>(starts) * numHeuristics);
+    vector<double> times(slots.size());
+    vector<Profile> profiles(kInstrumented ? slots.size() : 0);
+
+    pool.parallelFor(starts * numHeuristics, [&](int task) {
+        int h = task % numHeuristics;
+        int start = task / numHeuristics;
+        Profile before = profileSnapshot();
+        auto t0 = chrono::steady_clock::now();
+        slots[task] = heuristics[h](start);
+        times[task] = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        if (kInstrumented) profiles[task] = profileSnapshot() - before;
+    });
+
+    vector<MultiStartResult> results(numHeuristics);
+    for (int h = 0; h < numHeuristics; ++h) {
+        MultiStartResult& result = results[h];
+        result.scores.reserve(starts);
+        result.seconds.reserve(starts);
+        for (int start = 0; start < starts; ++start) {
+            size_t slot = static_cast<size_t>(start) * numHeuristics + h;
+            Solution& solution = slots[slot];
+            result.scores.push_back(solution.objective);
+            result.seconds.push_back(times[slot]);
+            if (kInstrumented) result.profile += profiles[slot];
+            if (result.bestScore == -1 || solution.objective < result.bestScore) {
+                result.bestScore = solution.objective;
+                result.bestPath = move(solution.path);
+            }
+        }
+    }
+    return results;
+}
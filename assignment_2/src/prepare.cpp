@@ -0,0 +1,67 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "node.h"
+#include "distance_matrix.h"
+#include "candidates.h"
+#include "instance_loader.h"
+#include "instance_cache.h"
+
+using namespace std;
+
+// Prepare
+// Writes the binary cache (see instance_cache.h) next to each instance CSV:
+// nodes, the distance matrix (16-bit entries when the instance allows it)
+// and the candidate lists. main and the solution checker use a cache when it
+// matches its CSV and fall back to parsing the CSV otherwise.
+//
+// Usage: prepare [--data DIR] [--candidates K] [INSTANCE...]
+// (default: ../../data, 10 candidates (0 = none), TSPA TSPB)
+
+template <typename T>
+bool prepare(const string& cacheFile, const string& csvFile, const vector<Node>& nodes, int candidateCount) {
+    DistanceMatrix<T> dist(nodes);
+    if (candidateCount <= 0) return writeInstanceCache(cacheFile, csvFile, nodes, dist, nullptr);
+    CandidateLists candidates(dist, nodes, candidateCount);
+    return writeInstanceCache(cacheFile, csvFile, nodes, dist, &candidates);
+}
+
+int main(int argc, char* argv[]) {
+    string dataDir = "../../data";
+    int candidateCount = 10;
+    vector<string> instances;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--candidates" && i + 1 < argc) {
+            candidateCount = stoi(argv[++i]);
+        } else {
+            instances.push_back(arg);
+        }
+    }
+    if (instances.empty()) instances = { "TSPA", "TSPB" };
+
+    int failures = 0;
+    for (const string& instance : instances) {
+        string csvFile = dataDir + "/" + instance + ".csv";
+        string cacheFile = instanceCachePath(csvFile);
+        vector<Node> nodes = loadNodes(csvFile);
+        if (nodes.empty()) {
+            ++failures;
+            continue;
+        }
+
+        bool narrow = DistanceMatrix<uint16_t>::fits(nodes);
+        bool written = narrow ? prepare<uint16_t>(cacheFile, csvFile, nodes, candidateCount)
+                              : prepare<int>(cacheFile, csvFile, nodes, candidateCount);
+        if (!written) {
+            ++failures;
+            continue;
+        }
+        cout << "Prepared " << cacheFile << " (" << nodes.size() << " nodes, "
+             << (narrow ? 16 : 32) << "-bit matrix, " << max(candidateCount, 0) << " candidates)" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
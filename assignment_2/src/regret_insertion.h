@@ -0,0 +1,161 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <limits>
+#include "node.h"
+#include "insertion.h"
+#include "simd_kernels.h"
+#include "arena.h"
+#include "unvisited_set.h"
+
+using namespace std;
+
+// Weighted selection score: regret * w.regret - (best insertion + node cost) * w.cost.
+// The default {1, 0} is the pure regret rule of greedyCycle2Regret.
+struct RegretWeights {
+    double regret = 1.0;
+    double cost = 0.0;
+};
+
+// Incremental K-regret insertion engine
+// Keeps, for every unvisited node, its K cheapest insertions into the current
+// cycle. Inserting a node splits one edge (u, v) into (u, k) and (k, v), so a
+// record only needs a full rescan when it referenced (u, v); otherwise the two
+// new edges are merged in. An edge is identified by its start node, and ties
+// are broken by position in the path, exactly like a left-to-right scan.
+// The per-node records and the cached edge lengths come from `arena`, which
+// must outlive the inserter.
+template <int K, typename Dist>
+class RegretInserter {
+    static_assert(K >= 1, "K-regret needs at least one insertion per node");
+
+public:
+    RegretInserter(const Dist& dist, const vector<Node>& nodes, Arena& arena, RegretWeights weights = {})
+        : dist_(dist), nodes_(nodes), weights_(weights),
+          records_(nodes.size(), Record{}, ArenaAllocator<Record>(arena)),
+          pos_(nodes.size(), -1, ArenaAllocator<int>(arena)), edgeLen_(ArenaAllocator<int>(arena)) {
+        // Room for a full cycle, so run() never allocates
+        edgeLen_.reserve(nodes.size());
+    }
+
+    // Grows the closed path (path.front() == path.back()) until it holds
+    // `target` distinct nodes, choosing only nodes still in `unvisited` and
+    // removing the ones it inserts. Returns the resulting change of the
+    // objective.
+    int run(vector<int>& path, UnvisitedSet& unvisited, int target) {
+        int delta = 0;
+        edgeLen_.clear();
+        for (size_t i = 0; i + 1 < path.size(); ++i)
+            edgeLen_.push_back(dist_[path[i]][path[i + 1]]);
+        reindex(path, 0);
+        for (int k : unvisited) rescan(path, k);
+
+        while (path.size() < static_cast<size_t>(target + 1)) {
+            int bestNode = -1;
+            double bestScore = 0.0;
+            for (int k : unvisited) {
+                double score = this->score(k);
+                if (bestNode == -1 || score > bestScore || (score == bestScore && k < bestNode)) {
+                    bestScore = score;
+                    bestNode = k;
+                }
+            }
+            if (bestNode == -1) break;
+
+            const Record& rec = records_[bestNode];
+            int u = rec.entries[0].edge;
+            int position = pos_[u] + 1;
+            int v = path[position];
+
+            edgeLen_[position - 1] = dist_[u][bestNode];
+            edgeLen_.insert(edgeLen_.begin() + position, dist_[bestNode][v]);
+            path.insert(path.begin() + position, bestNode);
+            unvisited.remove(bestNode);
+            delta += rec.entries[0].cost + nodes_[bestNode].cost;
+            reindex(path, position);
+
+            for (int k : unvisited) update(path, k, u, bestNode, v);
+        }
+        return delta;
+    }
+
+private:
+    struct Entry {
+        int cost;
+        int edge;
+    };
+
+    struct Record {
+        array<Entry, K> entries;
+        int count = 0;
+    };
+
+    double score(int k) const {
+        const Record& rec = records_[k];
+        double regret = 0.0;
+        for (int i = 1; i < rec.count; ++i)
+            regret += rec.entries[i].cost - rec.entries[0].cost;
+        return weights_.regret * regret - weights_.cost * (rec.entries[0].cost + nodes_[k].cost);
+    }
+
+    // Positions of path[from..] after an insertion; the closing copy of the
+    // first node is not indexed since no edge starts there.
+    void reindex(const vector<int>& path, size_t from) {
+        for (size_t i = from; i + 1 < path.size(); ++i)
+            pos_[path[i]] = static_cast<int>(i);
+    }
+
+    bool before(const Entry& a, const Entry& b) const {
+        if (a.cost != b.cost) return a.cost < b.cost;
+        return pos_[a.edge] < pos_[b.edge];
+    }
+
+    void offer(Record& rec, Entry e) {
+        int i = rec.count;
+        if (i == K) {
+            if (!before(e, rec.entries[K - 1])) return;
+            --i;
+        } else {
+            ++rec.count;
+        }
+        while (i > 0 && before(e, rec.entries[i - 1])) {
+            rec.entries[i] = rec.entries[i - 1];
+            --i;
+        }
+        rec.entries[i] = e;
+    }
+
+    // For K = 2 the whole cycle is scored by the vectorized best-two kernel
+    // over the cached edge lengths; it orders ties by position like offer().
+    void rescan(const vector<int>& path, int k) {
+        Record& rec = records_[k];
+        rec.count = 0;
+        if constexpr (K == 2) {
+            BestTwo two = bestInsertions(dist_[k], path.data(), edgeLen_.data(), path.size() - 1);
+            if (two.bestPos != -1) rec.entries[rec.count++] = { two.best, path[two.bestPos] };
+            if (two.secondPos != -1) rec.entries[rec.count++] = { two.second, path[two.secondPos] };
+            return;
+        }
+        for (size_t i = 0; i + 1 < path.size(); ++i)
+            offer(rec, { insertionCost(dist_, path[i], k, path[i + 1]), path[i] });
+    }
+
+    void update(const vector<int>& path, int k, int u, int inserted, int v) {
+        Record& rec = records_[k];
+        for (int i = 0; i < rec.count; ++i) {
+            if (rec.entries[i].edge == u) {
+                rescan(path, k);
+                return;
+            }
+        }
+        offer(rec, { insertionCost(dist_, u, k, inserted), u });
+        offer(rec, { insertionCost(dist_, inserted, k, v), inserted });
+    }
+
+    const Dist& dist_;
+    const vector<Node>& nodes_;
+    RegretWeights weights_;
+    ArenaVector<Record> records_;
+    ArenaVector<int> pos_;
+    ArenaVector<int> edgeLen_;   // edgeLen_[i] = dist[path[i]][path[i + 1]]
+};
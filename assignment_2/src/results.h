@@ -0,0 +1,237 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <iomanip>
+#include <numeric>
+#include <algorithm>
+#include "node.h"
+#include "multistart.h"
+#include "instrumentation.h"
+#include "json.h"
+
+using namespace std;
+
+// Console progress: Quiet prints nothing but errors, Normal the per-instance
+// progress lines, Verbose also a summary line per method.
+enum class Verbosity { Quiet, Normal, Verbose };
+
+// Every run of every method on one instance, in the order the methods were
+// added. seed is the root seed of the whole run (what --seed takes) and
+// index the instance's position in the run, which selects its random
+// stream. profile holds the work done outside the methods (load, matrix,
+// output phases).
+struct InstanceResults {
+    string instance;
+    int index = 0;
+    uint64_t seed = 0;
+    vector<Node> nodes;
+    vector<pair<string, MultiStartResult>> methods;
+    Profile profile;
+};
+
+// Writes (or appends) a whole file with a single open.
+inline void writeFile(const string& filename, const string& content, ios::openmode mode = ios::trunc) {
+    ofstream out(filename, ios::out | mode);
+    if (!out.is_open()) {
+        cerr << "Error: could not open " << filename << endl;
+        return;
+    }
+    out << content;
+}
+
+// Output format written once per instance.
+class ResultsSink {
+public:
+    virtual ~ResultsSink() = default;
+    virtual void write(const InstanceResults& results) = 0;
+    // File the last write went to, for the progress output.
+    virtual string target(const InstanceResults& results) const = 0;
+};
+
+// Best tour of every method as "<dir>/<instance>_paths.csv": for each method
+// its name, an "id,x,y,cost" header and one row per path entry, then a blank
+// line (the format analyze.py reads). Like the original saveResults, each run
+// appends to the file; delete it to start over.
+class PathsCsvSink : public ResultsSink {
+public:
+    explicit PathsCsvSink(string dir) : dir_(move(dir)) {}
+
+    void write(const InstanceResults& results) override {
+        ostringstream out;
+        for (const auto& [name, runs] : results.methods) {
+            out << name << "\n" << "id,x,y,cost\n";
+            for (int idx : runs.bestPath) {
+                const Node& node = results.nodes[idx];
+                out << node.id << "," << node.x << "," << node.y << "," << node.cost << "\n";
+            }
+            out << "\n";
+        }
+        writeFile(target(results), out.str(), ios::app);
+    }
+
+    string target(const InstanceResults& results) const override {
+        return dir_ + "/" + results.instance + "_paths.csv";
+    }
+
+private:
+    string dir_;
+};
+
+// "Avg (Min, Max)" objective table as "<dir>/<instance>_results_table.tex".
+class LatexTableSink : public ResultsSink {
+public:
+    explicit LatexTableSink(string dir) : dir_(move(dir)) {}
+
+    void write(const InstanceResults& results) override {
+        ostringstream out;
+        out << "\\begin{table}[h!]\n"
+            << "\\centering\n"
+            << "\\begin{tabular}{lc}\n"
+            << "\\hline\n"
+            << "Method & Avg (Min, Max) \\\\\n"
+            << "\\hline\n";
+        out << fixed << setprecision(2);
+        for (const auto& [name, runs] : results.methods) {
+            const vector<int>& values = runs.scores;
+            if (values.empty()) continue;
+            int minVal = *min_element(values.begin(), values.end());
+            int maxVal = *max_element(values.begin(), values.end());
+            double avgVal = accumulate(values.begin(), values.end(), 0.0) / values.size();
+            out << name << " & " << avgVal << " (" << minVal << ", " << maxVal << ") \\\\\n";
+        }
+        out << "\\hline\n"
+            << "\\end{tabular}\n"
+            << "\\caption{Average, minimum, and maximum objective values for " << results.instance << "}\n"
+            << "\\label{tab:" << results.instance << "_results}\n"
+            << "\\end{table}\n";
+        writeFile(target(results), out.str());
+    }
+
+    string target(const InstanceResults& results) const override {
+        return dir_ + "/" + results.instance + "_results_table.tex";
+    }
+
+private:
+    string dir_;
+};
+
+// One JSON object per run: instance, instance_index, seed, method, start,
+// objective and seconds. Rerunning main with --seed <seed> and the same
+// options reproduces the run (LNS only when capped by --lns-iterations).
+// The file is truncated when the sink is created and every instance is
+// appended to it.
+class JsonLinesSink : public ResultsSink {
+public:
+    explicit JsonLinesSink(string file) : file_(move(file)) { writeFile(file_, ""); }
+
+    void write(const InstanceResults& results) override {
+        ostringstream out;
+        out << setprecision(9);
+        for (const auto& [name, runs] : results.methods) {
+            for (size_t start = 0; start < runs.scores.size(); ++start) {
+                out << "{\"instance\": " << jsonString(results.instance) << ", \"instance_index\": " << results.index
+                    << ", \"seed\": " << results.seed
+                    << ", \"method\": " << jsonString(name) << ", \"start\": " << start
+                    << ", \"objective\": " << runs.scores[start]
+                    << ", \"seconds\": " << (start < runs.seconds.size() ? runs.seconds[start] : 0.0) << "}\n";
+            }
+        }
+        writeFile(file_, out.str(), ios::app);
+    }
+
+    string target(const InstanceResults&) const override { return file_; }
+
+private:
+    string file_;
+};
+
+// Instrumentation report as "<dir>/<instance>_profile.csv": one row per
+// method with its counters, phase seconds and hardware counters averaged per
+// call, then an "instance" row with the totals of the work outside the
+// methods. Its output time covers the sinks registered before this one.
+class ProfileSink : public ResultsSink {
+public:
+    explicit ProfileSink(string dir) : dir_(move(dir)) {}
+
+    void write(const InstanceResults& results) override {
+        ostringstream out;
+        out << "method,calls";
+        for (const char* name : kCounterNames) out << "," << name;
+        for (const char* name : kPhaseNames) out << "," << name << "_s";
+        for (const char* name : kHardwareCounterNames) out << "," << name;
+        out << "\n";
+        for (const auto& [name, runs] : results.methods)
+            writeRow(out, name, runs.profile, runs.scores.size());
+        writeRow(out, "instance", results.profile, 1);
+        writeFile(target(results), out.str());
+    }
+
+    string target(const InstanceResults& results) const override {
+        return dir_ + "/" + results.instance + "_profile.csv";
+    }
+
+private:
+    static void writeRow(ostream& out, const string& name, const Profile& profile, size_t calls) {
+        double scale = calls ? 1.0 / calls : 0.0;
+        out << name << "," << calls << setprecision(9);
+        for (uint64_t count : profile.counts) out << "," << count * scale;
+        for (double seconds : profile.seconds) out << "," << seconds * scale;
+        for (uint64_t value : profile.hardware) out << "," << value * scale;
+        out << "\n";
+    }
+
+    string dir_;
+};
+
+// Results Collector
+// Methods are added as their multi-start runs finish; flush() hands the
+// instance to every sink in one go and starts over for the next one.
+class Results {
+public:
+    explicit Results(Verbosity verbosity = Verbosity::Normal) : verbosity_(verbosity) {}
+
+    void addSink(unique_ptr<ResultsSink> sink) { sinks_.push_back(move(sink)); }
+
+    bool shows(Verbosity level) const { return verbosity_ >= level; }
+
+    void beginInstance(const string& instance, int index, const vector<Node>& nodes, uint64_t seed) {
+        current_ = InstanceResults{ instance, index, seed, nodes, {}, {} };
+    }
+
+    void add(const string& method, MultiStartResult runs) {
+        if (shows(Verbosity::Verbose)) {
+            const vector<int>& scores = runs.scores;
+            double avg = scores.empty() ? 0.0 : accumulate(scores.begin(), scores.end(), 0.0) / scores.size();
+            double seconds = accumulate(runs.seconds.begin(), runs.seconds.end(), 0.0);
+            cout << "  " << left << setw(40) << method << right << fixed << setprecision(2) << setw(12) << avg
+                 << "  best " << setw(8) << runs.bestScore << setprecision(3) << setw(10) << seconds << " s\n";
+        }
+        current_.methods.emplace_back(method, move(runs));
+    }
+
+    // Adds work done for the instance outside the methods, e.g. loading.
+    void addProfile(const Profile& profile) { current_.profile += profile; }
+
+    void flush() {
+        for (const auto& sink : sinks_) {
+            Profile before = profileSnapshot();
+            {
+                EC_PHASE(Output);
+                sink->write(current_);
+            }
+            current_.profile += profileSnapshot() - before;
+            if (shows(Verbosity::Normal)) cout << "Results saved to: " << sink->target(current_) << "\n";
+        }
+        cout.flush();
+        current_ = InstanceResults{};
+    }
+
+private:
+    Verbosity verbosity_;
+    vector<unique_ptr<ResultsSink>> sinks_;
+    InstanceResults current_;
+};
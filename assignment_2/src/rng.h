@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// SplitMix64 step, used to expand seeds into generator state.
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator
+// 32 bytes of state and a handful of instructions per draw. Satisfies the
+// UniformRandomBitGenerator requirements, so it also works with <random>.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0) {
+        for (uint64_t& word : s_) word = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, bound) without modulo bias (Lemire's method).
+    uint32_t below(uint32_t bound) {
+        uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            uint32_t threshold = -bound % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(static_cast<uint32_t>((*this)() >> 32)) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // Uniform double in [0, 1) from the top 53 bits.
+    double unit() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+// Splittable seed tree
+// Every stream is a pure function of the root seed and the path of ids used
+// to reach it, so results do not depend on which thread ran which task.
+class RngStreams {
+public:
+    explicit RngStreams(uint64_t seed) : seed_(seed) {}
+
+    uint64_t seed() const { return seed_; }
+
+    // Independent sub-tree, e.g. one per instance or per heuristic.
+    RngStreams split(uint64_t id) const { return RngStreams(derive(id)); }
+
+    // Generator for one task, e.g. one per start index.
+    Xoshiro256 stream(uint64_t id) const { return Xoshiro256(derive(id)); }
+
+private:
+    uint64_t derive(uint64_t id) const {
+        uint64_t state = seed_ ^ (id * 0xD1B54A32D192ED03ULL);
+        splitmix64(state);
+        return splitmix64(state);
+    }
+
+    uint64_t seed_;
+};
+
+// Global seed: the EC_SEED environment variable if set, otherwise a fresh
+// value from random_device. main lets --seed override it; the chosen seed is
+// printed so any run can be replayed exactly. An empty EC_SEED counts as
+// unset; one that is not a plain unsigned integer is ignored with a warning.
+inline uint64_t defaultSeed() {
+    const char* env = getenv("EC_SEED");
+    if (env && *env) {
+        string value = env;
+        size_t used = 0;
+        try {
+            uint64_t seed = value.find('-') == string::npos ? stoull(value, &used) : 0;
+            if (used > 0 && used == value.size()) return seed;
+        } catch (const logic_error&) {
+        }
+        cerr << "Warning: Ignoring EC_SEED '" << value << "', not an unsigned 64-bit integer" << endl;
+    }
+    random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
@@ -0,0 +1,179 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+#include <map>
+#include <cmath>
+#include "node.h"
+#include "distance_matrix.h"
+#include "coordinate_distance.h"
+#include "heuristics.h"
+#include "instance_generator.h"
+
+using namespace std;
+
+// Large-n scaling mode
+// Generates instances of growing size and runs each constructor once (from
+// node 0) on them, reporting wall time and objective. Distances come from a
+// DistanceMatrix while it fits under --memory-limit, and are computed from
+// coordinates beyond that (CoordinateDistance). Instances are density-matched
+// to TSPA/TSPB (see densityMatched). --time-limit is a per-size cutoff, not a
+// budget: before a heuristic runs on a size, its time is extrapolated from
+// the previous size with its complexity exponent, and it is skipped for this
+// and all larger sizes when the estimate is over the limit. A run that has
+// started is never interrupted, and the estimate does not account for the
+// slower coordinate backend, so a run can still overshoot. The table shows
+// where each heuristic stops scaling.
+//
+// Usage: scaling [--sizes 1000,10000,100000,1000000] [--layout uniform|clustered|grid]
+//                [--costs uniform|exponential|constant] [--memory-limit MB]
+//                [--time-limit S per size] [--save DIR] [--out FILE] [--seed S]
+
+struct ScalingRow {
+    string layout;
+    int n;
+    string backend;
+    string function;
+    double seconds;
+    int objective;
+};
+
+// Last completed run of a heuristic, the base of the next size's estimate.
+struct LastRun {
+    int n = 0;
+    double seconds = 0;
+    bool stopped = false;
+};
+
+template <typename Dist>
+void runHeuristics(const string& layout, const vector<Node>& nodes, const Dist& dist, const string& backend,
+                   double timeLimit, map<string, LastRun>& last, vector<ScalingRow>& rows) {
+    int n = nodes.size();
+    // A single start, so the partner tables are not worth precomputing
+    SolverContext context(dist, nodes);
+    // Time grows as n^exponent: n per step for the row scan, about constant
+    // for the grid, and one insertion scan of O(n^2) per step for the
+    // insertion heuristics. The incremental regret repairs only the
+    // affected records and measures between n^2 and n^2.5. The spatial
+    // variant runs the row scan below kSpatialMinNodes, so its estimate
+    // from such a size uses the row scan's exponent.
+    struct Heuristic {
+        string name;
+        double exponent;
+        function<Solution()> run;
+    };
+    vector<Heuristic> heuristics = {
+        { "nearestNeighborEnd", 2, [&] { return nearestNeighborEnd(context, 0); } },
+        { "nearestNeighborEndSpatial", 1, [&] { return nearestNeighborEndSpatial(context, 0); } },
+        { "nearestNeighborFlexible", 3, [&] { return nearestNeighborFlexible(context, 0); } },
+        { "greedyCycle", 3, [&] { return greedyCycle(context, 0); } },
+        { "greedyCycle2Regret", 2.5, [&] { return greedyCycle2Regret(context, 0); } },
+    };
+    for (auto& [name, exponent, run] : heuristics) {
+        LastRun& previous = last[name];
+        double growth = name == "nearestNeighborEndSpatial" && previous.n < kSpatialMinNodes ? 2 : exponent;
+        double estimate = previous.n > 0 ? previous.seconds * pow(static_cast<double>(n) / previous.n, growth) : 0;
+        if (estimate > timeLimit) previous.stopped = true;
+        if (previous.stopped) {
+            cout << left << setw(10) << n << setw(28) << name << "skipped (estimated over the time limit)" << endl;
+            continue;
+        }
+        auto t0 = chrono::steady_clock::now();
+        Solution solution = run();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        previous = { n, seconds, seconds > timeLimit };
+
+        rows.push_back({ layout, n, backend, name, seconds, solution.objective });
+        cout << left << setw(10) << n << setw(28) << name << right << fixed << setprecision(3)
+             << setw(12) << seconds << " s" << setw(14) << solution.objective << "  [" << backend << "]" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    vector<int> sizes = { 1000, 10000, 100000, 1000000 };
+    string layoutName = "uniform";
+    string costsName = "uniform";
+    double memoryLimitMb = 1024;
+    double timeLimit = 60;
+    string saveDir;
+    string outFile = "../results/scaling.csv";
+    uint64_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) sizes.push_back(stoi(item));
+        } else if (arg == "--layout" && i + 1 < argc) {
+            layoutName = argv[++i];
+        } else if (arg == "--costs" && i + 1 < argc) {
+            costsName = argv[++i];
+        } else if (arg == "--memory-limit" && i + 1 < argc) {
+            memoryLimitMb = stod(argv[++i]);
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            timeLimit = stod(argv[++i]);
+        } else if (arg == "--save" && i + 1 < argc) {
+            saveDir = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = stoull(argv[++i]);
+        } else {
+            cerr << "Warning: Ignoring unknown argument: " << arg << endl;
+        }
+    }
+
+    InstanceOptions options;
+    if (layoutName == "clustered") options.layout = Layout::Clustered;
+    else if (layoutName == "grid") options.layout = Layout::Grid;
+    else if (layoutName != "uniform") cerr << "Warning: Unknown layout " << layoutName << ", using uniform" << endl;
+    if (costsName == "exponential") options.costs = CostDistribution::Exponential;
+    else if (costsName == "constant") options.costs = CostDistribution::Constant;
+    else if (costsName != "uniform") cerr << "Warning: Unknown cost distribution " << costsName << ", using uniform" << endl;
+    size_t memoryLimit = static_cast<size_t>(memoryLimitMb * 1024 * 1024);
+
+    vector<ScalingRow> rows;
+    map<string, LastRun> last;
+    for (int n : sizes) {
+        vector<Node> nodes = generateInstance(n, densityMatched(options, n), seed + n);
+        if (!saveDir.empty())
+            saveNodes(saveDir + "/" + layoutName + "_" + costsName + "_" + to_string(n) + ".csv", nodes);
+
+        auto t0 = chrono::steady_clock::now();
+        if (DistanceMatrix<uint16_t>::fits(nodes) && denseMatrixBytes<uint16_t>(n) <= memoryLimit) {
+            DistanceMatrix<uint16_t> dist(nodes);
+            rows.push_back({ layoutName, n, "matrix16", "distances",
+                             chrono::duration<double>(chrono::steady_clock::now() - t0).count(), 0 });
+            runHeuristics(layoutName, nodes, dist, "matrix16", timeLimit, last, rows);
+        } else if (denseMatrixBytes<int>(n) <= memoryLimit) {
+            DistanceMatrix<int> dist(nodes);
+            rows.push_back({ layoutName, n, "matrix32", "distances",
+                             chrono::duration<double>(chrono::steady_clock::now() - t0).count(), 0 });
+            runHeuristics(layoutName, nodes, dist, "matrix32", timeLimit, last, rows);
+        } else {
+            CoordinateDistance dist(nodes);
+            rows.push_back({ layoutName, n, "coordinates", "distances",
+                             chrono::duration<double>(chrono::steady_clock::now() - t0).count(), 0 });
+            runHeuristics(layoutName, nodes, dist, "coordinates", timeLimit, last, rows);
+        }
+    }
+
+    ofstream out(outFile);
+    if (!out.is_open()) {
+        cerr << "Error: could not create scaling file: " << outFile << endl;
+    }
+    out << "layout,costs,n,backend,function,seconds,objective\n";
+    for (const ScalingRow& row : rows)
+        out << row.layout << "," << costsName << "," << row.n << "," << row.backend << "," << row.function << ","
+            << fixed << setprecision(6) << row.seconds << "," << row.objective << "\n";
+    out.close();
+
+    cout << "\nScaling results saved to: " << outFile << endl;
+    return 0;
+}
@@ -0,0 +1,235 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "instrumentation.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define EC_HAVE_AVX2_KERNELS 1
+#else
+#define EC_HAVE_AVX2_KERNELS 0
+#endif
+
+using namespace std;
+
+// Masked argmin
+// Returns the j with the smallest row[j] + cost[j] among the j where
+// visited[j] == 0, the lowest j on ties, or -1 if every node is visited.
+// cost may be null, in which case only row[j] is compared. The score of the
+// winner is written to bestScore. Scalar reference version; row may be any
+// indexable row (a matrix row pointer or a computed-distance row):
+template <typename Row>
+int maskedArgminScalar(const Row& row, const int* cost, const uint8_t* visited, int n, int& bestScore) {
+    int bestNode = -1;
+    bestScore = numeric_limits<int>::max();
+    for (int j = 0; j < n; ++j) {
+        if (visited[j]) continue;
+        int score = static_cast<int>(row[j]) + (cost ? cost[j] : 0);
+        if (score < bestScore) {
+            bestScore = score;
+            bestNode = j;
+        }
+    }
+    return bestNode;
+}
+
+
+// Best and second-best edge insertion
+// For edges i in [0, edges), edge i joining tour[i] and tour[i + 1] with
+// length edgeLen[i], the cost of inserting node k is
+// row[tour[i]] + row[tour[i + 1]] - edgeLen[i], where row is k's row of the
+// (symmetric) matrix. Returns the two smallest costs in (cost, position)
+// order, i.e. what a left-to-right scan with strict comparisons finds.
+// Missing entries have cost INT_MAX and position -1.
+struct BestTwo {
+    int best = numeric_limits<int>::max();
+    int bestPos = -1;
+    int second = numeric_limits<int>::max();
+    int secondPos = -1;
+
+    void offer(int cost, int pos) {
+        if (cost < best || (cost == best && pos < bestPos)) {
+            second = best;
+            secondPos = bestPos;
+            best = cost;
+            bestPos = pos;
+        } else if (cost < second || (cost == second && pos < secondPos)) {
+            second = cost;
+            secondPos = pos;
+        }
+    }
+};
+
+template <typename Row>
+BestTwo bestInsertionsScalar(const Row& row, const int* tour, const int* edgeLen, int edges) {
+    BestTwo result;
+    for (int i = 0; i < edges; ++i) {
+        int cost = static_cast<int>(row[tour[i]]) + static_cast<int>(row[tour[i + 1]]) - edgeLen[i];
+        if (cost < result.best) {
+            result.second = result.best;
+            result.secondPos = result.bestPos;
+            result.best = cost;
+            result.bestPos = i;
+        } else if (cost < result.second) {
+            result.second = cost;
+            result.secondPos = i;
+        }
+    }
+    return result;
+}
+
+#if EC_HAVE_AVX2_KERNELS
+
+// 8 lanes of row + cost; each lane keeps its first minimum, so the lowest
+// index among lanes holding the overall minimum is the scalar answer.
+template <typename T>
+__attribute__((target("avx2")))
+int maskedArgminAvx2(const T* row, const int* cost, const uint8_t* visited, int n, int& bestScore) {
+    const __m256i maxScore = _mm256_set1_epi32(numeric_limits<int>::max());
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i best = maxScore;
+    __m256i bestIdx = _mm256_set1_epi32(-1);
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256i score;
+        if constexpr (sizeof(T) == 2) {
+            score = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j)));
+        } else {
+            score = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+        }
+        if (cost) score = _mm256_add_epi32(score, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cost + j)));
+
+        __m256i seen = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(visited + j)));
+        __m256i open = _mm256_cmpeq_epi32(seen, zero);
+        score = _mm256_blendv_epi8(maxScore, score, open);
+
+        __m256i better = _mm256_cmpgt_epi32(best, score);
+        best = _mm256_blendv_epi8(best, score, better);
+        bestIdx = _mm256_blendv_epi8(bestIdx, idx, better);
+        idx = _mm256_add_epi32(idx, step);
+    }
+
+    alignas(32) int lanes[8];
+    alignas(32) int laneIdx[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(laneIdx), bestIdx);
+
+    int bestNode = -1;
+    bestScore = numeric_limits<int>::max();
+    for (int lane = 0; lane < 8; ++lane) {
+        if (laneIdx[lane] == -1) continue;
+        if (lanes[lane] < bestScore || (lanes[lane] == bestScore && laneIdx[lane] < bestNode)) {
+            bestScore = lanes[lane];
+            bestNode = laneIdx[lane];
+        }
+    }
+
+    for (; j < n; ++j) {
+        if (visited[j]) continue;
+        int score = static_cast<int>(row[j]) + (cost ? cost[j] : 0);
+        if (score < bestScore) {
+            bestScore = score;
+            bestNode = j;
+        }
+    }
+    return bestNode;
+}
+
+// Gathers row[index] for 8 indices; 16-bit rows are read as 32-bit words
+// and masked, which is why DistanceMatrix pads its storage.
+template <typename T>
+__attribute__((target("avx2")))
+inline __m256i gatherRow(const T* row, __m256i index) {
+    if constexpr (sizeof(T) == 2) {
+        __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(row), index, 2);
+        return _mm256_and_si256(words, _mm256_set1_epi32(0xFFFF));
+    } else {
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(row), index, 4);
+    }
+}
+
+// Each lane keeps its own best two in scan order; the lane results are
+// merged by (cost, position), which gives the scalar answer.
+template <typename T>
+__attribute__((target("avx2")))
+BestTwo bestInsertionsAvx2(const T* row, const int* tour, const int* edgeLen, int edges) {
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i best = _mm256_set1_epi32(numeric_limits<int>::max());
+    __m256i second = best;
+    __m256i bestIdx = _mm256_set1_epi32(-1);
+    __m256i secondIdx = bestIdx;
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    int i = 0;
+    for (; i + 8 <= edges; i += 8) {
+        __m256i from = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + i));
+        __m256i to = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + i + 1));
+        __m256i len = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(edgeLen + i));
+        __m256i cost = _mm256_sub_epi32(_mm256_add_epi32(gatherRow(row, from), gatherRow(row, to)), len);
+
+        __m256i beatsBest = _mm256_cmpgt_epi32(best, cost);
+        __m256i beatsSecond = _mm256_cmpgt_epi32(second, cost);
+        second = _mm256_blendv_epi8(_mm256_blendv_epi8(second, cost, beatsSecond), best, beatsBest);
+        secondIdx = _mm256_blendv_epi8(_mm256_blendv_epi8(secondIdx, idx, beatsSecond), bestIdx, beatsBest);
+        best = _mm256_blendv_epi8(best, cost, beatsBest);
+        bestIdx = _mm256_blendv_epi8(bestIdx, idx, beatsBest);
+        idx = _mm256_add_epi32(idx, step);
+    }
+
+    alignas(32) int lanes[4][8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), best);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), bestIdx);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[2]), second);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[3]), secondIdx);
+
+    BestTwo result;
+    for (int lane = 0; lane < 8; ++lane) {
+        if (lanes[1][lane] != -1) result.offer(lanes[0][lane], lanes[1][lane]);
+        if (lanes[3][lane] != -1) result.offer(lanes[2][lane], lanes[3][lane]);
+    }
+    for (; i < edges; ++i)
+        result.offer(static_cast<int>(row[tour[i]]) + static_cast<int>(row[tour[i + 1]]) - edgeLen[i], i);
+    return result;
+}
+
+inline bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif
+
+// Rows the AVX2 kernels can read directly: pointers to 16- or 32-bit entries.
+template <typename Row>
+constexpr bool isVectorRow = is_pointer_v<Row> &&
+    (is_same_v<remove_cv_t<remove_pointer_t<Row>>, uint16_t> || is_same_v<remove_cv_t<remove_pointer_t<Row>>, int>);
+
+// Runtime dispatch: AVX2 for 16- and 32-bit rows when the CPU has it,
+// the scalar loop otherwise.
+template <typename Row>
+int maskedArgmin(const Row& row, const int* cost, const uint8_t* visited, int n, int& bestScore) {
+    EC_COUNT(InsertionEvals, n);
+    EC_COUNT(MatrixReads, n);
+#if EC_HAVE_AVX2_KERNELS
+    if constexpr (isVectorRow<Row>) {
+        if (cpuHasAvx2()) return maskedArgminAvx2(row, cost, visited, n, bestScore);
+    }
+#endif
+    return maskedArgminScalar(row, cost, visited, n, bestScore);
+}
+
+template <typename Row>
+BestTwo bestInsertions(const Row& row, const int* tour, const int* edgeLen, int edges) {
+    EC_COUNT(InsertionEvals, edges);
+    EC_COUNT(MatrixReads, 2 * edges);
+#if EC_HAVE_AVX2_KERNELS
+    if constexpr (isVectorRow<Row>) {
+        if (cpuHasAvx2()) return bestInsertionsAvx2(row, tour, edgeLen, edges);
+    }
+#endif
+    return bestInsertionsScalar(row, tour, edgeLen, edges);
+}
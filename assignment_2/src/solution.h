@@ -0,0 +1,9 @@
+#pragma once
+#include <vector>
+
+// A constructed path together with its objective value, so callers do not
+// have to run computeObjective again on every result.
+struct Solution {
+    std::vector<int> path;
+    int objective;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cctype>
+#include "node.h"
+#include "heuristics.h"
+#include "instance_loader.h"
+
+using namespace std;
+
+// Outcome of checking one solution against an instance. objective is only
+// meaningful when every node id is in range.
+struct SolutionCheck {
+    bool valid = false;
+    int objective = 0;
+    int length = 0;      // ids in the path, closing copy included
+    int distinct = 0;    // distinct ids in the cycle
+    vector<string> errors;
+};
+
+// Parses whitespace-separated node ids in [begin, end) into path. Returns
+// false, with the offending token in error, on anything else.
+inline bool parseSolution(const char* begin, const char* end, vector<int>& path, string& error) {
+    path.clear();
+    const char* p = begin;
+    while (true) {
+        while (p < end && isspace(static_cast<unsigned char>(*p))) ++p;
+        if (p == end) return true;
+        const char* token = p;
+        int value;
+        if (!parseInt(p, end, value) || (p < end && !isspace(static_cast<unsigned char>(*p)))) {
+            while (p < end && !isspace(static_cast<unsigned char>(*p))) ++p;
+            error = "malformed token '" + string(token, p) + "'";
+            return false;
+        }
+        path.push_back(value);
+    }
+}
+
+// Nodes a solution selects under the assignment's rule: half of the n nodes,
+// rounded up when n is odd (as selectNodes does). The constructive
+// heuristics select n / 2, so on odd n their solutions have one node less.
+inline int requiredNodes(int n) { return (n + 1) / 2; }
+
+// Feasibility check of a closed path (first id repeated at the end): every id
+// is a node of the instance, no node is visited twice, the cycle has exactly
+// `required` nodes (requiredNodes(n) when negative) and it is closed. The
+// objective is computed as in computeObjective.
+template <typename Dist>
+SolutionCheck checkSolution(const vector<int>& path, const Dist& dist, const vector<Node>& nodes,
+                            int required = -1) {
+    SolutionCheck check;
+    int n = nodes.size();
+    if (required < 0) required = requiredNodes(n);
+    check.length = path.size();
+    if (path.empty()) {
+        check.errors.push_back("empty solution");
+        return check;
+    }
+
+    bool inRange = true;
+    for (int node : path) {
+        if (node < 0 || node >= n) {
+            check.errors.push_back("node " + to_string(node) + " out of range [0, " + to_string(n) + ")");
+            inRange = false;
+        }
+    }
+
+    bool closed = path.size() >= 2 && path.front() == path.back();
+    if (!closed) check.errors.push_back("path does not return to its first node");
+
+    if (inRange) {
+        vector<uint8_t> seen(n, 0);
+        size_t cycleLength = closed ? path.size() - 1 : path.size();
+        for (size_t i = 0; i < cycleLength; ++i) {
+            if (seen[path[i]]++) check.errors.push_back("node " + to_string(path[i]) + " visited twice");
+            else ++check.distinct;
+        }
+        check.objective = computeObjective(path, dist, nodes);
+    }
+    if (inRange && check.distinct != required)
+        check.errors.push_back(to_string(check.distinct) + " distinct nodes, expected " + to_string(required));
+
+    check.valid = check.errors.empty();
+    return check;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "node.h"
+#include "candidates.h"
+#include "simd_kernels.h"
+#include "spatial_index.h"
+#include "tour.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Buffers a heuristic call needs besides its result. There is one set per
+// thread and it is reused by every call on that thread, so a multi-start run
+// allocates them once instead of once per start. Callers reset what they use.
+struct SolverScratch {
+    vector<uint8_t> visited;
+    vector<int> edgeLen;
+    LinkedTour tour{ 0 };
+    SpatialGrid grid{ vector<Node>{} };
+};
+
+// Solver Context
+// Everything the heuristics derive from an instance alone, built once and
+// shared read-only by all starts and threads: the distance provider, the
+// nodes and their costs as a flat array, the spatial grid, optional
+// candidate (sorted neighbour) lists and, after precomputePartners(), the
+// best partner of every node for the 2-node seed cycles. Without the partner
+// tables the partners are computed per call, which is the better choice when
+// only a few starts are run on a large instance.
+template <typename Dist>
+class SolverContext {
+public:
+    SolverContext(const Dist& dist, const vector<Node>& nodes, const CandidateLists* candidates = nullptr)
+        : dist_(dist), nodes_(nodes), candidates_(candidates), costs_(nodes.size()), grid_(nodes) {
+        for (const Node& node : nodes) costs_[node.id] = node.cost;
+    }
+
+    // Fills the partner tables; O(n^2), so only worth it when most nodes are
+    // used as starts.
+    void precomputePartners() {
+        EC_PHASE(Matrix);
+        int n = nodes_.size();
+        bestPartner_.resize(n);
+        nearestPartner_.resize(n);
+        for (int i = 0; i < n; ++i) {
+            bestPartner_[i] = partner(i, costs_.data());
+            nearestPartner_[i] = partner(i, nullptr);
+        }
+    }
+
+    const Dist& dist() const { return dist_; }
+    const vector<Node>& nodes() const { return nodes_; }
+    int size() const { return nodes_.size(); }
+    const int* costs() const { return costs_.data(); }
+    const SpatialGrid& grid() const { return grid_; }
+
+    // Requires the context to have been built with candidate lists.
+    const CandidateLists& candidates() const { return *candidates_; }
+    bool hasCandidates() const { return candidates_ != nullptr; }
+
+    // Node j != i with the smallest dist[i][j] + cost[j], lowest id on ties.
+    int bestPartner(int i) const { return bestPartner_.empty() ? partner(i, costs_.data()) : bestPartner_[i]; }
+
+    // Node j != i with the smallest dist[i][j], lowest id on ties.
+    int nearestPartner(int i) const { return nearestPartner_.empty() ? partner(i, nullptr) : nearestPartner_[i]; }
+
+    // Scratch buffers of the calling thread.
+    SolverScratch& scratch() const {
+        static thread_local SolverScratch scratch;
+        return scratch;
+    }
+
+private:
+    int partner(int i, const int* cost) const {
+        vector<uint8_t>& mask = scratch().visited;
+        mask.assign(nodes_.size(), 0);
+        mask[i] = 1;
+        int score;
+        return maskedArgmin(scanRow(dist_, i), cost, mask.data(), nodes_.size(), score);
+    }
+
+    const Dist& dist_;
+    const vector<Node>& nodes_;
+    const CandidateLists* candidates_;
+    vector<int> costs_;
+    SpatialGrid grid_;
+    vector<int> bestPartner_;
+    vector<int> nearestPartner_;
+};
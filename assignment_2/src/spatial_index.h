@@ -0,0 +1,152 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "node.h"
+#include "instrumentation.h"
+
+using namespace std;
+
+// Spatial Grid
+// Uniform grid of square cells over the node coordinates for "nearest
+// remaining node by distance (+ cost)" queries, with nodes removed as they get
+// visited. Cells are aligned to integer coordinates, so the distance from a
+// query point to a cell is exact and, being computed with the same
+// round(sqrt(...)) as the distance itself, a true lower bound. A query visits
+// rings of cells around the query cell and stops once the ring distance plus
+// the global minimum cost cannot beat the best score; cells whose distance
+// plus their own minimum cost cannot beat it are skipped. Results equal a
+// linear scan, lowest id first on ties.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(const vector<Node>& nodes, double nodesPerCell = 2.0)
+        : xs_(nodes.size()), ys_(nodes.size()), costs_(nodes.size()), slot_(nodes.size(), -1) {
+        if (nodes.empty()) return;
+        minX_ = nodes[0].x, minY_ = nodes[0].y;
+        int maxX = nodes[0].x, maxY = nodes[0].y;
+        for (const Node& node : nodes) {
+            minX_ = min(minX_, node.x); maxX = max(maxX, node.x);
+            minY_ = min(minY_, node.y); maxY = max(maxY, node.y);
+        }
+        int width = maxX - minX_ + 1;
+        int height = maxY - minY_ + 1;
+        double cellArea = static_cast<double>(width) * height * nodesPerCell / nodes.size();
+        cellSize_ = max(1, static_cast<int>(ceil(sqrt(cellArea))));
+        cols_ = (width + cellSize_ - 1) / cellSize_;
+        rows_ = (height + cellSize_ - 1) / cellSize_;
+
+        int cells = cols_ * rows_;
+        cellStart_.assign(cells + 1, 0);
+        cellCount_.assign(cells, 0);
+        cellMinCost_.assign(cells, numeric_limits<int>::max());
+        minCost_ = numeric_limits<int>::max();
+        for (const Node& node : nodes) {
+            xs_[node.id] = node.x;
+            ys_[node.id] = node.y;
+            costs_[node.id] = node.cost;
+            int c = cellOf(node.x, node.y);
+            ++cellStart_[c + 1];
+            cellMinCost_[c] = min(cellMinCost_[c], node.cost);
+            minCost_ = min(minCost_, node.cost);
+        }
+        for (int c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+        cellNodes_.resize(nodes.size());
+        for (int id = 0; id < static_cast<int>(nodes.size()); ++id) {
+            int c = cellOf(xs_[id], ys_[id]);
+            slot_[id] = cellStart_[c] + cellCount_[c]++;
+            cellNodes_[slot_[id]] = id;
+        }
+        live_ = nodes.size();
+    }
+
+    int size() const { return live_; }
+    bool contains(int id) const { return slot_[id] != -1; }
+
+    // Removes a node from future queries; O(1).
+    void remove(int id) {
+        int s = slot_[id];
+        if (s == -1) return;
+        int c = cellOf(xs_[id], ys_[id]);
+        int last = cellStart_[c] + --cellCount_[c];
+        int moved = cellNodes_[last];
+        cellNodes_[s] = moved;
+        slot_[moved] = s;
+        cellNodes_[last] = id;
+        slot_[id] = -1;
+        --live_;
+    }
+
+    // Remaining node j with the smallest distance(from, j) + cost[j] (just the
+    // distance if withCost is false), lowest id on ties; -1 if none remain.
+    // The score of the winner is written to bestScore.
+    int nearest(int from, bool withCost, int& bestScore) const {
+        int x = xs_[from], y = ys_[from];
+        int qc = (x - minX_) / cellSize_;
+        int qr = (y - minY_) / cellSize_;
+        int minCost = withCost ? minCost_ : 0;
+        int maxRing = max(max(qc, cols_ - 1 - qc), max(qr, rows_ - 1 - qr));
+
+        int bestNode = -1;
+        bestScore = numeric_limits<int>::max();
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            // Every cell of this ring is at least this far away.
+            long long ringDist = ring == 0 ? 0 : static_cast<long long>(ring - 1) * cellSize_ + 1;
+            if (bestNode != -1 && ringDist + minCost > bestScore) break;
+
+            for (int r = qr - ring; r <= qr + ring; ++r) {
+                if (r < 0 || r >= rows_) continue;
+                // Inner rows of the ring only have their two end cells.
+                bool edgeRow = r == qr - ring || r == qr + ring;
+                for (int c = qc - ring; c <= qc + ring; c += edgeRow ? 1 : 2 * ring) {
+                    if (c < 0 || c >= cols_) continue;
+                    scanCell(r * cols_ + c, x, y, withCost, bestNode, bestScore);
+                }
+            }
+        }
+        return bestNode;
+    }
+
+private:
+    // Same arithmetic as DistanceMatrix<>::euclidean.
+    static int distance(double dx, double dy) {
+        return static_cast<int>(round(sqrt(dx * dx + dy * dy)));
+    }
+
+    int cellOf(int x, int y) const {
+        return ((y - minY_) / cellSize_) * cols_ + (x - minX_) / cellSize_;
+    }
+
+    void scanCell(int cell, int x, int y, bool withCost, int& bestNode, int& bestScore) const {
+        if (cellCount_[cell] == 0) return;
+        int x0 = minX_ + (cell % cols_) * cellSize_;
+        int y0 = minY_ + (cell / cols_) * cellSize_;
+        int dx = x < x0 ? x0 - x : max(0, x - (x0 + cellSize_ - 1));
+        int dy = y < y0 ? y0 - y : max(0, y - (y0 + cellSize_ - 1));
+        long long bound = static_cast<long long>(distance(dx, dy)) + (withCost ? cellMinCost_[cell] : 0);
+        if (bestNode != -1 && bound > bestScore) return;
+        EC_COUNT(InsertionEvals, cellCount_[cell]);
+
+        const int* begin = cellNodes_.data() + cellStart_[cell];
+        for (const int* it = begin; it != begin + cellCount_[cell]; ++it) {
+            int j = *it;
+            int score = distance(x - xs_[j], y - ys_[j]) + (withCost ? costs_[j] : 0);
+            if (score < bestScore || (score == bestScore && j < bestNode)) {
+                bestScore = score;
+                bestNode = j;
+            }
+        }
+    }
+
+    vector<int> xs_, ys_, costs_;
+    vector<int> slot_;          // index of each node in cellNodes_, -1 once removed
+    vector<int> cellNodes_;     // node ids grouped by cell, live ones first
+    vector<int> cellStart_;
+    vector<int> cellCount_;     // live nodes per cell
+    vector<int> cellMinCost_;   // over all nodes ever in the cell
+    int minX_ = 0, minY_ = 0;
+    int cellSize_ = 1;
+    int cols_ = 0, rows_ = 0;
+    int minCost_ = 0;
+    int live_ = 0;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+
+// Fixed-size worker pool
+// Workers are started once and reused for every parallelFor call. With a
+// single thread the tasks run inline on the caller, so a serial run has no
+// threading overhead at all.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = thread::hardware_concurrency())
+        : threads_(max(1u, threads)) {
+        for (unsigned i = 1; i < threads_; ++i)
+            workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (thread& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return threads_; }
+
+    // Runs task(i) for every i in [0, count) and returns once all are done.
+    // Indices are handed out dynamically, so the order tasks run in is
+    // unspecified; callers write results into per-index slots.
+    void parallelFor(int count, const function<void(int)>& task) {
+        if (count <= 0) return;
+        if (threads_ == 1 || count == 1) {
+            for (int i = 0; i < count; ++i) task(i);
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_.store(0);
+            active_ = static_cast<int>(workers_.size());
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drain();
+
+        unique_lock<mutex> lock(mutex_);
+        done_.wait(lock, [this] { return active_ == 0; });
+        task_ = nullptr;
+    }
+
+private:
+    void drain() {
+        for (int i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1))
+            (*task_)(i);
+    }
+
+    void workerLoop() {
+        unsigned long long seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+            }
+
+            drain();
+
+            {
+                lock_guard<mutex> lock(mutex_);
+                if (--active_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    unsigned threads_;
+    vector<thread> workers_;
+    mutex mutex_;
+    condition_variable wake_;
+    condition_variable done_;
+    const function<void(int)>* task_ = nullptr;
+    int count_ = 0;
+    atomic<int> next_{0};
+    int active_ = 0;
+    unsigned long long generation_ = 0;
+    bool stopping_ = false;
+};
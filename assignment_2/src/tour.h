@@ -0,0 +1,171 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+
+// Tours
+// Two representations of a cycle over a subset of the node ids 0..n-1, both
+// convertible to the closed vector<int> format (first node repeated at the
+// end) used by Solution and saveResults.
+//
+// LinkedTour: successor/predecessor arrays indexed by node id. Insert-after,
+//   remove, next and prev are O(1); there are no positions. For
+//   constructors that grow a tour one node at a time.
+// ArrayTour: nodes in cycle order plus a node -> position index. Position
+//   lookup is O(1) and a segment reversal (2-opt) touches only the segment;
+//   inserting or removing shifts the tail. For local search; Alloc lets the
+//   two arrays live in an Arena (see arena.h).
+
+class LinkedTour {
+public:
+    explicit LinkedTour(int n) : next_(n, -1), prev_(n, -1) {}
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool contains(int node) const { return next_[node] != -1; }
+
+    // Node the tour is read from; stays the same unless it is removed.
+    int front() const { return front_; }
+    int next(int node) const { return next_[node]; }
+    int prev(int node) const { return prev_[node]; }
+
+    // Empties the tour for nodes 0..n-1, reusing the storage.
+    void reset(int n) {
+        next_.assign(n, -1);
+        prev_.assign(n, -1);
+        front_ = -1;
+        size_ = 0;
+    }
+
+    // Starts an empty tour with a single node (a cycle of one).
+    void start(int node) {
+        next_[node] = prev_[node] = node;
+        front_ = node;
+        size_ = 1;
+    }
+
+    // Inserts node between u and next(u).
+    void insertAfter(int u, int node) {
+        int v = next_[u];
+        next_[u] = node;
+        prev_[node] = u;
+        next_[node] = v;
+        prev_[v] = node;
+        ++size_;
+    }
+
+    void remove(int node) {
+        int u = prev_[node], v = next_[node];
+        next_[u] = v;
+        prev_[v] = u;
+        next_[node] = prev_[node] = -1;
+        if (--size_ == 0) front_ = -1;
+        else if (node == front_) front_ = v;
+    }
+
+    // Visits the nodes in cycle order from front().
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        if (size_ == 0) return;
+        int node = front_;
+        do {
+            visit(node);
+            node = next_[node];
+        } while (node != front_);
+    }
+
+    vector<int> toPath() const {
+        vector<int> path;
+        path.reserve(size_ + 1);
+        forEach([&](int node) { path.push_back(node); });
+        if (size_ > 0) path.push_back(front_);
+        return path;
+    }
+
+private:
+    vector<int> next_;
+    vector<int> prev_;
+    int front_ = -1;
+    int size_ = 0;
+};
+
+template <typename Alloc = allocator<int>>
+class ArrayTour {
+public:
+    explicit ArrayTour(const Alloc& alloc = Alloc()) : order_(alloc), pos_(alloc) {}
+    explicit ArrayTour(int n, const Alloc& alloc = Alloc()) : order_(alloc), pos_(n, -1, alloc) {}
+
+    // Loads a closed path or an open sequence read as a cycle, keeping the
+    // first occurrence of every node.
+    void assign(const vector<int>& path, int n) {
+        order_.clear();
+        pos_.assign(n, -1);
+        for (int node : path) {
+            if (pos_[node] != -1) continue;
+            pos_[node] = order_.size();
+            order_.push_back(node);
+        }
+    }
+
+    int size() const { return order_.size(); }
+    bool contains(int node) const { return pos_[node] != -1; }
+
+    // Node at position i, and position of a node (-1 if not in the tour).
+    int operator[](int i) const { return order_[i]; }
+    int position(int node) const { return pos_[node]; }
+
+    // Neighbouring positions, wrapping around.
+    int next(int i) const { return i + 1 == size() ? 0 : i + 1; }
+    int prev(int i) const { return i == 0 ? size() - 1 : i - 1; }
+
+    // Neighbouring nodes of a node in the tour.
+    int succ(int node) const { return order_[next(pos_[node])]; }
+    int pred(int node) const { return order_[prev(pos_[node])]; }
+
+    typename vector<int, Alloc>::const_iterator begin() const { return order_.begin(); }
+    typename vector<int, Alloc>::const_iterator end() const { return order_.end(); }
+
+    // Puts `node` (not in the tour) at position i in place of the current one.
+    void replace(int i, int node) {
+        pos_[order_[i]] = -1;
+        order_[i] = node;
+        pos_[node] = i;
+    }
+
+    void swapPositions(int i, int j) {
+        swap(order_[i], order_[j]);
+        pos_[order_[i]] = i;
+        pos_[order_[j]] = j;
+    }
+
+    // Reverses positions i..j (inclusive, i <= j); the 2-opt step.
+    void reverse(int i, int j) {
+        std::reverse(order_.begin() + i, order_.begin() + j + 1);
+        for (int k = i; k <= j; ++k) pos_[order_[k]] = k;
+    }
+
+    void insertAfter(int i, int node) {
+        order_.insert(order_.begin() + i + 1, node);
+        for (int k = i + 1; k < size(); ++k) pos_[order_[k]] = k;
+    }
+
+    void remove(int i) {
+        pos_[order_[i]] = -1;
+        order_.erase(order_.begin() + i);
+        for (int k = i; k < size(); ++k) pos_[order_[k]] = k;
+    }
+
+    vector<int> toPath() const {
+        vector<int> path;
+        path.reserve(order_.size() + 1);
+        path.assign(order_.begin(), order_.end());
+        if (!path.empty()) path.push_back(path[0]);
+        return path;
+    }
+
+private:
+    vector<int, Alloc> order_;
+    vector<int, Alloc> pos_;
+};
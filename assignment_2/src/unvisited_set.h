@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <numeric>
+#include "arena.h"
+
+using namespace std;
+
+// Unvisited Set
+// The nodes 0..n-1 a construction has not used yet: a dense array of the
+// remaining ids with O(1) swap-remove, the slot of every id in that array,
+// and per-node byte flags (1 = removed) in the mask format of maskedArgmin.
+// Iterating visits only the remaining ids, but in no particular order once
+// something was removed, so scans that must prefer the lowest id on ties
+// compare ids explicitly. The arrays come from `arena`, which must outlive
+// the set.
+class UnvisitedSet {
+public:
+    UnvisitedSet(int n, Arena& arena)
+        : n_(n), ids_(n, ArenaAllocator<int>(arena)), slot_(n, ArenaAllocator<int>(arena)),
+          removed_(n, ArenaAllocator<uint8_t>(arena)) {
+        reset();
+    }
+
+    // Puts every node back.
+    void reset() {
+        iota(ids_.begin(), ids_.end(), 0);
+        iota(slot_.begin(), slot_.end(), 0);
+        fill(removed_.begin(), removed_.end(), 0);
+        size_ = n_;
+    }
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool contains(int id) const { return !removed_[id]; }
+
+    // Removes a remaining node by moving the last remaining id into its slot.
+    void remove(int id) {
+        int s = slot_[id];
+        int last = ids_[--size_];
+        ids_[s] = last;
+        slot_[last] = s;
+        ids_[size_] = id;
+        slot_[id] = size_;
+        removed_[id] = 1;
+    }
+
+    const int* begin() const { return ids_.data(); }
+    const int* end() const { return ids_.data() + size_; }
+
+    const uint8_t* removedMask() const { return removed_.data(); }
+
+private:
+    const int n_;
+    ArenaVector<int> ids_;         // ids_[0..size_) remain
+    ArenaVector<int> slot_;        // index of every id in ids_
+    ArenaVector<uint8_t> removed_;
+    int size_ = 0;
+};
@@ -0,0 +1,197 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include "../assignment_2/src/node.h"
+#include "../assignment_2/src/distance_matrix.h"
+#include "../assignment_2/src/instance_loader.h"
+#include "../assignment_2/src/instance_cache.h"
+#include "../assignment_2/src/thread_pool.h"
+#include "../assignment_2/src/solution_validation.h"
+#include "../assignment_2/src/json.h"
+
+using namespace std;
+
+// Batch Solution Checker
+// Validates and scores many solutions of one instance in parallel. Every
+// SOURCE is a solution file (whitespace-separated node ids, closed path), a
+// directory whose regular files are all checked, or "-" for one solution per
+// line on stdin. Each solution is checked for id range, duplicates, size and
+// closure (see checkSolution), and one report row per solution is written as
+// CSV or JSON. Exits with 1 if any solution is invalid. The size defaults to
+// the assignment's ceil(n / 2); --selected floor accepts the n / 2 nodes the
+// constructive heuristics select on odd n, and a number sets it directly.
+//
+// Usage: batch_checker --instance data/TSPA.csv [--threads N] [--format csv|json]
+//                      [--selected ceil|floor|K] [--out FILE] SOURCE...
+
+struct SolutionInput {
+    string source;
+    string text;
+};
+
+string csvEscape(const string& text) {
+    if (text.find_first_of(",\"\n") == string::npos) return text;
+    string escaped = "\"";
+    for (char ch : text) {
+        if (ch == '"') escaped += '"';
+        escaped += ch;
+    }
+    return escaped + "\"";
+}
+
+// Paths of the solution files of every source; stdin lines become inputs
+// directly.
+void collectInputs(const string& source, vector<string>& files, vector<SolutionInput>& inputs) {
+    namespace fs = std::filesystem;
+    if (source == "-") {
+        string line;
+        for (int lineNumber = 1; getline(cin, line); ++lineNumber)
+            if (line.find_first_not_of(" \t\r") != string::npos)
+                inputs.push_back({ "stdin:" + to_string(lineNumber), line });
+        return;
+    }
+    error_code ec;
+    if (fs::is_directory(source, ec)) {
+        vector<string> entries;
+        for (const auto& entry : fs::directory_iterator(source, ec))
+            if (entry.is_regular_file()) entries.push_back(entry.path().string());
+        sort(entries.begin(), entries.end());
+        files.insert(files.end(), entries.begin(), entries.end());
+    } else {
+        files.push_back(source);
+    }
+}
+
+template <typename Dist>
+vector<SolutionCheck> checkAll(ThreadPool& pool, const vector<SolutionInput>& inputs, const vector<string>& files,
+                               const Dist& dist, const vector<Node>& nodes, int required) {
+    size_t total = inputs.size() + files.size();
+    vector<SolutionCheck> checks(total);
+    pool.parallelFor(total, [&](int i) {
+        static thread_local vector<int> path;
+        string error;
+        bool parsed;
+        if (static_cast<size_t>(i) < inputs.size()) {
+            const string& text = inputs[i].text;
+            parsed = parseSolution(text.data(), text.data() + text.size(), path, error);
+        } else {
+            MappedFile file(files[i - inputs.size()]);
+            if (!file.opened()) {
+                checks[i].errors.push_back("could not open file");
+                return;
+            }
+            parsed = parseSolution(file.begin(), file.end(), path, error);
+        }
+        if (!parsed) {
+            checks[i].errors.push_back(error);
+            return;
+        }
+        checks[i] = checkSolution(path, dist, nodes, required);
+    });
+    return checks;
+}
+
+int main(int argc, char* argv[]) {
+    string instanceFile;
+    unsigned threads = thread::hardware_concurrency();
+    string format = "csv";
+    string outFile;
+    string selected = "ceil";
+    vector<string> sources;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--instance" && i + 1 < argc) {
+            instanceFile = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int count = stoi(argv[++i]);
+            if (count > 0) threads = count;
+            else if (count == 0) threads = thread::hardware_concurrency();
+            else cerr << "Warning: Ignoring --threads " << count << ", it cannot be negative" << endl;
+        } else if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--selected" && i + 1 < argc) {
+            selected = argv[++i];
+        } else {
+            sources.push_back(arg);
+        }
+    }
+    bool selectedValid = selected == "ceil" || selected == "floor" ||
+                         (!selected.empty() && selected.size() <= 9 && selected.find_first_not_of("0123456789") == string::npos);
+    if (instanceFile.empty() || sources.empty() || (format != "csv" && format != "json") || !selectedValid) {
+        cerr << "Usage: batch_checker --instance FILE.csv [--threads N] [--format csv|json] "
+                "[--selected ceil|floor|K] [--out FILE] SOURCE..." << endl;
+        return 2;
+    }
+
+    InstanceCache cache(instanceCachePath(instanceFile), instanceFile);
+    vector<Node> nodes = cache.valid() ? cache.nodes() : loadNodes(instanceFile);
+    if (nodes.empty()) return 2;
+    int n = nodes.size();
+    int required = selected == "ceil" ? requiredNodes(n) : selected == "floor" ? n / 2 : stoi(selected);
+
+    vector<string> files;
+    vector<SolutionInput> inputs;
+    for (const string& source : sources) collectInputs(source, files, inputs);
+
+    ThreadPool pool(threads);
+    vector<SolutionCheck> checks;
+    if (cache.valid() && cache.elementSize() == sizeof(uint16_t))
+        checks = checkAll(pool, inputs, files, cache.matrix<uint16_t>(), nodes, required);
+    else if (cache.valid())
+        checks = checkAll(pool, inputs, files, cache.matrix<int>(), nodes, required);
+    else if (DistanceMatrix<uint16_t>::fits(nodes))
+        checks = checkAll(pool, inputs, files, DistanceMatrix<uint16_t>(nodes), nodes, required);
+    else
+        checks = checkAll(pool, inputs, files, DistanceMatrix<int>(nodes), nodes, required);
+
+    auto sourceOf = [&](size_t i) { return i < inputs.size() ? inputs[i].source : files[i - inputs.size()]; };
+
+    ofstream fileOut;
+    if (!outFile.empty()) {
+        fileOut.open(outFile);
+        if (!fileOut.is_open()) {
+            cerr << "Error: could not create report file: " << outFile << endl;
+            return 2;
+        }
+    }
+    ostream& out = outFile.empty() ? cout : fileOut;
+
+    if (format == "csv") out << "source,valid,objective,length,distinct,errors\n";
+    else out << "[\n";
+    int validCount = 0;
+    int bestIndex = -1;
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const SolutionCheck& check = checks[i];
+        string errors;
+        for (const string& error : check.errors) errors += (errors.empty() ? "" : "; ") + error;
+        if (check.valid) {
+            ++validCount;
+            if (bestIndex == -1 || check.objective < checks[bestIndex].objective) bestIndex = i;
+        }
+
+        if (format == "csv") {
+            out << csvEscape(sourceOf(i)) << "," << (check.valid ? "true" : "false") << ","
+                << check.objective << "," << check.length << "," << check.distinct << "," << csvEscape(errors) << "\n";
+        } else {
+            out << "  {\"source\": " << jsonString(sourceOf(i)) << ", \"valid\": " << (check.valid ? "true" : "false")
+                << ", \"objective\": " << check.objective << ", \"length\": " << check.length
+                << ", \"distinct\": " << check.distinct << ", \"errors\": [";
+            for (size_t e = 0; e < check.errors.size(); ++e)
+                out << (e ? ", " : "") << jsonString(check.errors[e]);
+            out << "]}" << (i + 1 < checks.size() ? "," : "") << "\n";
+        }
+    }
+    if (format == "json") out << "]\n";
+
+    cerr << validCount << " of " << checks.size() << " solutions valid";
+    if (bestIndex != -1) cerr << ", best " << checks[bestIndex].objective << " (" << sourceOf(bestIndex) << ")";
+    cerr << endl;
+    return validCount == static_cast<int>(checks.size()) ? 0 : 1;
+}